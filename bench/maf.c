@@ -0,0 +1,89 @@
+// Times the maf.h matrix and quaternion routines, including the batched ones.  Build it with and
+// without MAF_NO_SIMD to compare the SIMD paths against the scalar ones (the bench_maf and
+// bench_maf_scalar targets do this).
+
+#include "core/maf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define COUNT 1024
+#define ROUNDS 8000
+
+static float matrices[16 * COUNT];
+static float products[16 * COUNT];
+static float points[4 * COUNT];
+static float quats[4 * COUNT];
+static float targets[4 * COUNT];
+static float sink;
+
+static float randomFloat(void) {
+  return (float) rand() / RAND_MAX * 2.f - 1.f;
+}
+
+static void report(const char* name, clock_t start, size_t operations) {
+  double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+  printf("%-20s %8.2f ns/op\n", name, seconds * 1e9 / operations);
+}
+
+int main(void) {
+  float m[16];
+  mat4_identity(m);
+  mat4_rotate(m, .5f, 0.f, 1.f, 0.f);
+  mat4_translate(m, 1.f, 2.f, 3.f);
+
+  for (size_t i = 0; i < 16 * COUNT; i++) matrices[i] = randomFloat();
+  for (size_t i = 0; i < 4 * COUNT; i++) points[i] = randomFloat();
+  for (size_t i = 0; i < COUNT; i++) {
+    quat_fromAngleAxis(quats + 4 * i, randomFloat() * 3.f, randomFloat(), randomFloat(), randomFloat());
+    quat_fromAngleAxis(targets + 4 * i, randomFloat() * 3.f, randomFloat(), randomFloat(), randomFloat());
+  }
+
+#ifdef MAF_SIMD
+  printf("maf.h with SIMD\n");
+#else
+  printf("maf.h without SIMD\n");
+#endif
+
+  clock_t start = clock();
+  for (size_t r = 0; r < ROUNDS; r++) {
+    for (size_t i = 0; i < COUNT; i++) {
+      float product[16];
+      mat4_multiply(mat4_init(product, m), matrices + 16 * i);
+      sink += product[r & 15];
+    }
+  }
+  report("mat4_multiply", start, (size_t) ROUNDS * COUNT);
+
+  start = clock();
+  for (size_t r = 0; r < ROUNDS; r++) {
+    mat4_multiplyMany(products, m, matrices, COUNT);
+    sink += products[r & 15];
+  }
+  report("mat4_multiplyMany", start, (size_t) ROUNDS * COUNT);
+
+  start = clock();
+  for (size_t r = 0; r < ROUNDS; r++) {
+    for (size_t i = 0; i < COUNT; i++) {
+      mat4_transform(m, points + 4 * i);
+    }
+    sink += points[r & 15];
+  }
+  report("mat4_transform", start, (size_t) ROUNDS * COUNT);
+
+  start = clock();
+  for (size_t r = 0; r < ROUNDS; r++) {
+    mat4_transformPoints(m, points, COUNT, 4);
+    sink += points[r & 15];
+  }
+  report("mat4_transformPoints", start, (size_t) ROUNDS * COUNT);
+
+  start = clock();
+  for (size_t r = 0; r < ROUNDS; r++) {
+    quat_slerpMany(quats, quats, targets, .01f, COUNT);
+    sink += quats[r & 15];
+  }
+  report("quat_slerpMany", start, (size_t) ROUNDS * COUNT);
+
+  return sink == 12345.f;
+}
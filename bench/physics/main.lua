@@ -0,0 +1,51 @@
+-- Drops a pile of boxes into a World with each broadphase and prints how long collision detection
+-- took, with the kinematic floor in the main space and then in the static space.  Run with
+-- `lovr bench/physics [colliders] [steps]`.
+
+local broadphases = { 'hash', 'sap', 'quadtree', 'simple' }
+
+local function run(broadphase, staticSpace, count, steps)
+  local world = lovr.physics.newWorld(0, -9.81, 0, true, nil, {
+    broadphase = broadphase,
+    staticSpace = staticSpace,
+    center = { 0, 16, 0 },
+    size = 64
+  })
+
+  world:newBoxCollider(0, -.5, 0, 64, 1, 64):setKinematic(true)
+
+  local side = math.ceil(count ^ (1 / 3))
+  for i = 0, count - 1 do
+    local x = i % side
+    local y = math.floor(i / side) % side
+    local z = math.floor(i / (side * side))
+    world:newBoxCollider(x * 1.1 - side / 2, 1 + y * 1.1, z * 1.1 - side / 2, 1, 1, 1)
+  end
+
+  local collision, tested, accepted = 0, 0, 0
+  local start = lovr.timer.getTime()
+  for i = 1, steps do
+    world:update(1 / 60)
+    local t, a = world:getPairCounts()
+    collision = collision + world:getCollisionTime()
+    tested, accepted = tested + t, accepted + a
+  end
+  local total = lovr.timer.getTime() - start
+
+  print(string.format('%-9s %-7s %8.3fms/step %8.3fms collision %9d tested %9d accepted',
+    broadphase, staticSpace and 'static' or '', total / steps * 1000, collision / steps * 1000, math.floor(tested / steps), math.floor(accepted / steps)))
+
+  world:destroy()
+end
+
+function lovr.load(arg)
+  local count = tonumber(arg[1]) or 1000
+  local steps = tonumber(arg[2]) or 300
+  print(string.format('%d colliders, %d steps', count, steps))
+  for _, staticSpace in ipairs({ false, true }) do
+    for _, broadphase in ipairs(broadphases) do
+      run(broadphase, staticSpace, count, steps)
+    end
+  end
+  lovr.event.quit()
+end
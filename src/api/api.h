@@ -22,6 +22,7 @@ LOVR_EXPORT int luaopen_lovr_timer(lua_State* L);
 extern const luaL_Reg lovrModules[];
 
 // Objects
+extern const luaL_Reg lovrAnimationState[];
 extern const luaL_Reg lovrAudioStream[];
 extern const luaL_Reg lovrBallJoint[];
 extern const luaL_Reg lovrBlob[];
@@ -35,6 +36,7 @@ extern const luaL_Reg lovrCylinderShape[];
 extern const luaL_Reg lovrDistanceJoint[];
 extern const luaL_Reg lovrFont[];
 extern const luaL_Reg lovrHingeJoint[];
+extern const luaL_Reg lovrJob[];
 extern const luaL_Reg lovrMat4[];
 extern const luaL_Reg lovrMaterial[];
 extern const luaL_Reg lovrMesh[];
@@ -72,6 +74,7 @@ extern StringEntry lovrAttributeType[];
 extern StringEntry lovrBlendAlphaMode[];
 extern StringEntry lovrBlendMode[];
 extern StringEntry lovrBlockType[];
+extern StringEntry lovrBroadphaseType[];
 extern StringEntry lovrBufferUsage[];
 extern StringEntry lovrCompareMode[];
 extern StringEntry lovrCoordinateSpace[];
@@ -89,6 +92,8 @@ extern StringEntry lovrJointType[];
 extern StringEntry lovrMaterialColor[];
 extern StringEntry lovrMaterialScalar[];
 extern StringEntry lovrMaterialTexture[];
+extern StringEntry lovrPoseFormat[];
+extern StringEntry lovrRandomDistribution[];
 extern StringEntry lovrShaderType[];
 extern StringEntry lovrShapeType[];
 extern StringEntry lovrSourceType[];
@@ -166,8 +171,10 @@ void* luax_readfile(const char* filename, size_t* bytesRead);
 
 #ifdef LOVR_ENABLE_GRAPHICS
 struct Attachment;
+struct Model;
 struct Texture;
 struct Uniform;
+uint32_t luax_checkanimation(lua_State* L, int index, struct Model* model);
 int luax_checkuniform(lua_State* L, int index, const struct Uniform* uniform, void* dest, const char* debug);
 int luax_optmipmap(lua_State* L, int index, struct Texture* texture);
 void luax_readattachments(lua_State* L, int index, struct Attachment* attachments, int* count);
@@ -188,8 +195,10 @@ uint64_t luax_checkrandomseed(lua_State* L, int index);
 #ifdef LOVR_ENABLE_PHYSICS
 struct Joint;
 struct Shape;
+struct TriMesh;
 void luax_pushjoint(lua_State* L, struct Joint* joint);
 void luax_pushshape(lua_State* L, struct Shape* shape);
 struct Joint* luax_checkjoint(lua_State* L, int index);
 struct Shape* luax_checkshape(lua_State* L, int index);
+struct TriMesh* luax_checktrimesh(lua_State* L, int index);
 #endif
@@ -1,5 +1,7 @@
 #include "api.h"
 #include "data/blob.h"
+#include "core/ref.h"
+#include <stdlib.h>
 
 static int l_lovrBlobGetName(lua_State* L) {
   Blob* blob = luax_checktype(L, 1, Blob);
@@ -9,6 +11,7 @@ static int l_lovrBlobGetName(lua_State* L) {
 
 static int l_lovrBlobGetPointer(lua_State* L) {
   Blob* blob = luax_checktype(L, 1, Blob);
+  lovrAssert(!blob->parent, "Blob views are read only, use getString or the parent Blob's pointer instead");
   lua_pushlightuserdata(L, blob->data);
   return 1;
 }
@@ -25,10 +28,37 @@ static int l_lovrBlobGetString(lua_State* L) {
   return 1;
 }
 
+static int l_lovrBlobGetParent(lua_State* L) {
+  Blob* blob = luax_checktype(L, 1, Blob);
+  luax_pushtype(L, Blob, blob->parent);
+  return 1;
+}
+
+static int l_lovrBlobView(lua_State* L) {
+  Blob* blob = luax_checktype(L, 1, Blob);
+  size_t offset = luaL_optinteger(L, 2, 0);
+  size_t size = luaL_optinteger(L, 3, offset < blob->size ? blob->size - offset : 0);
+  Blob* view = lovrBlobCreateView(blob, offset, size);
+  luax_pushtype(L, Blob, view);
+  lovrRelease(Blob, view);
+  return 1;
+}
+
+static int l_lovrBlobMove(lua_State* L) {
+  Blob* blob = luax_checktype(L, 1, Blob);
+  Blob* moved = lovrBlobMove(blob);
+  luax_pushtype(L, Blob, moved);
+  lovrRelease(Blob, moved);
+  return 1;
+}
+
 const luaL_Reg lovrBlob[] = {
   { "getName", l_lovrBlobGetName },
   { "getPointer", l_lovrBlobGetPointer },
   { "getSize", l_lovrBlobGetSize },
   { "getString", l_lovrBlobGetString },
+  { "getParent", l_lovrBlobGetParent },
+  { "view", l_lovrBlobView },
+  { "move", l_lovrBlobMove },
   { NULL, NULL }
 };
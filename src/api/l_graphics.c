@@ -556,7 +556,7 @@ static int l_lovrGraphicsGetStats(lua_State* L) {
     luaL_checktype(L, 1, LUA_TTABLE);
     lua_settop(L, 1);
   } else {
-    lua_createtable(L, 0, 7);
+    lua_createtable(L, 0, 12);
   }
 
   lovrGraphicsFlush();
@@ -575,6 +575,16 @@ static int l_lovrGraphicsGetStats(lua_State* L) {
   lua_setfield(L, 1, "buffermemory");
   lua_pushinteger(L, stats->textureMemory);
   lua_setfield(L, 1, "texturememory");
+  lua_pushinteger(L, stats->fenceCount);
+  lua_setfield(L, 1, "fences");
+  lua_pushinteger(L, stats->fenceStalls);
+  lua_setfield(L, 1, "fencestalls");
+  lua_pushinteger(L, stats->streamMemory);
+  lua_setfield(L, 1, "streammemory");
+  lua_pushinteger(L, stats->streamPeak);
+  lua_setfield(L, 1, "streampeak");
+  lua_pushinteger(L, lovrGraphicsGetCulledCount());
+  lua_setfield(L, 1, "culled");
   return 1;
 }
 
@@ -760,6 +770,16 @@ static int l_lovrGraphicsSetShader(lua_State* L) {
   return 0;
 }
 
+static int l_lovrGraphicsIsSortingEnabled(lua_State* L) {
+  lua_pushboolean(L, lovrGraphicsIsSortingEnabled());
+  return 1;
+}
+
+static int l_lovrGraphicsSetSortingEnabled(lua_State* L) {
+  lovrGraphicsSetSortingEnabled(lua_toboolean(L, 1));
+  return 0;
+}
+
 static int l_lovrGraphicsGetStencilTest(lua_State* L) {
   CompareMode mode;
   int value;
@@ -1445,6 +1465,16 @@ static int l_lovrGraphicsNewModel(lua_State* L) {
   return 1;
 }
 
+static int l_lovrGraphicsNewAnimationState(lua_State* L) {
+  Model* model = luax_checktype(L, 1, Model);
+  uint32_t animation = luax_checkanimation(L, 2, model);
+  AnimationState* state = lovrAnimationStateCreate(lovrModelGetModelData(model), animation);
+  lovrAnimationStateSample(state, luax_optfloat(L, 3, 0.f));
+  luax_pushtype(L, AnimationState, state);
+  lovrRelease(AnimationState, state);
+  return 1;
+}
+
 static const char* luax_readshadersource(lua_State* L, int index, int *outLength) {
   if (lua_isnoneornil(L, index)) {
     return NULL;
@@ -1775,6 +1805,8 @@ static const luaL_Reg lovrGraphics[] = {
   { "setPointSize", l_lovrGraphicsSetPointSize },
   { "getShader", l_lovrGraphicsGetShader },
   { "setShader", l_lovrGraphicsSetShader },
+  { "isSortingEnabled", l_lovrGraphicsIsSortingEnabled },
+  { "setSortingEnabled", l_lovrGraphicsSetSortingEnabled },
   { "getStencilTest", l_lovrGraphicsGetStencilTest },
   { "setStencilTest", l_lovrGraphicsSetStencilTest },
   { "getWinding", l_lovrGraphicsGetWinding },
@@ -1812,6 +1844,7 @@ static const luaL_Reg lovrGraphics[] = {
   { "compute", l_lovrGraphicsCompute },
 
   // Types
+  { "newAnimationState", l_lovrGraphicsNewAnimationState },
   { "newCanvas", l_lovrGraphicsNewCanvas },
   { "newFont", l_lovrGraphicsNewFont },
   { "newMaterial", l_lovrGraphicsNewMaterial },
@@ -1828,6 +1861,7 @@ static const luaL_Reg lovrGraphics[] = {
 int luaopen_lovr_graphics(lua_State* L) {
   lua_newtable(L);
   luax_register(L, lovrGraphics);
+  luax_registertype(L, AnimationState);
   luax_registertype(L, Canvas);
   luax_registertype(L, Font);
   luax_registertype(L, Material);
@@ -1840,15 +1874,25 @@ int luaopen_lovr_graphics(lua_State* L) {
   luax_pushconf(L);
 
   bool debug = false;
+  uint32_t vertexCount = 0;
+  uint32_t indexCount = 0;
   lua_getfield(L, -1, "graphics");
   if (lua_istable(L, -1)) {
     lua_getfield(L, -1, "debug");
     debug = lua_toboolean(L, -1);
     lua_pop(L, 1);
+
+    lua_getfield(L, -1, "vertices");
+    vertexCount = luaL_optinteger(L, -1, 0);
+    lua_pop(L, 1);
+
+    lua_getfield(L, -1, "indices");
+    indexCount = luaL_optinteger(L, -1, 0);
+    lua_pop(L, 1);
   }
   lua_pop(L, 1);
 
-  lovrGraphicsInit(debug);
+  lovrGraphicsInit(debug, vertexCount, indexCount);
 
   lua_pushcfunction(L, l_lovrGraphicsCreateWindow);
   lua_getfield(L, -2, "window");
@@ -0,0 +1,118 @@
+#include "api.h"
+#include "graphics/model.h"
+#include "data/modelData.h"
+#include "core/job.h"
+#include "core/ref.h"
+#include <stdlib.h>
+#ifdef LOVR_ENABLE_THREAD
+#include "thread/thread.h"
+#endif
+
+static int l_lovrAnimationStateGetAnimation(lua_State* L) {
+  AnimationState* state = luax_checktype(L, 1, AnimationState);
+  uint32_t animation = lovrAnimationStateGetAnimation(state);
+  const char* name = lovrAnimationStateGetModelData(state)->animations[animation].name;
+  lua_pushinteger(L, animation + 1);
+  if (name) {
+    lua_pushstring(L, name);
+    return 2;
+  }
+  return 1;
+}
+
+static int l_lovrAnimationStateGetDuration(lua_State* L) {
+  AnimationState* state = luax_checktype(L, 1, AnimationState);
+  lua_pushnumber(L, lovrAnimationStateGetDuration(state));
+  return 1;
+}
+
+static int l_lovrAnimationStateGetTime(lua_State* L) {
+  AnimationState* state = luax_checktype(L, 1, AnimationState);
+  lua_pushnumber(L, lovrAnimationStateGetTime(state));
+  return 1;
+}
+
+static int l_lovrAnimationStateSetTime(lua_State* L) {
+  AnimationState* state = luax_checktype(L, 1, AnimationState);
+  float time = luax_checkfloat(L, 2);
+  lovrAnimationStateSample(state, time);
+  return 0;
+}
+
+typedef struct {
+  AnimationState* state;
+  float alpha;
+  uint32_t count;
+  Model* models[];
+} ApplyContext;
+
+static void applyAnimation(void* context, uint32_t index) {
+  ApplyContext* apply = context;
+  lovrModelApplyAnimation(apply->models[index], apply->state, apply->alpha);
+}
+
+static void releaseApplyContext(void* context) {
+  ApplyContext* apply = context;
+  for (uint32_t i = 0; i < apply->count; i++) {
+    lovrRelease(Model, apply->models[i]);
+  }
+  lovrRelease(AnimationState, apply->state);
+  free(apply);
+}
+
+// Each Model is posed by its own job, so a table of Models is spread across the job workers.
+// Models must not appear more than once in the table, and they can't be drawn or posed until the
+// Job (if one is given) is complete.
+static int l_lovrAnimationStateApply(lua_State* L) {
+  AnimationState* state = luax_checktype(L, 1, AnimationState);
+  float alpha = luax_optfloat(L, 3, 1.f);
+
+  if (!lua_istable(L, 2)) {
+    Model* model = luax_checktype(L, 2, Model);
+    lovrModelApplyAnimation(model, state, alpha);
+    return 0;
+  }
+
+  uint32_t count = luax_len(L, 2);
+  ApplyContext* apply = malloc(sizeof(ApplyContext) + count * sizeof(Model*));
+  lovrAssert(apply, "Out of memory");
+  apply->state = state;
+  apply->alpha = alpha;
+  apply->count = 0;
+  lovrRetain(state);
+
+  for (uint32_t i = 0; i < count; i++) {
+    lua_rawgeti(L, 2, i + 1);
+    Model* model = luax_totype(L, -1, Model);
+    lua_pop(L, 1);
+    if (!model || lovrModelGetModelData(model) != lovrAnimationStateGetModelData(state)) {
+      releaseApplyContext(apply);
+      lovrThrow("Expected a table of Models using the AnimationState's ModelData");
+    }
+    lovrRetain(model);
+    apply->models[apply->count++] = model;
+  }
+
+#ifdef LOVR_ENABLE_THREAD
+  Job* job = luax_totype(L, 4, Job);
+  if (job) {
+    lovrJobRun(job, applyAnimation, apply, count, releaseApplyContext);
+    return 0;
+  }
+#endif
+
+  JobCounter counter = { 0 };
+  job_run(applyAnimation, apply, count, &counter, NULL);
+  job_wait(&counter);
+  releaseApplyContext(apply);
+  return 0;
+}
+
+const luaL_Reg lovrAnimationState[] = {
+  { "getAnimation", l_lovrAnimationStateGetAnimation },
+  { "getDuration", l_lovrAnimationStateGetDuration },
+  { "getTime", l_lovrAnimationStateGetTime },
+  { "setTime", l_lovrAnimationStateSetTime },
+  { "apply", l_lovrAnimationStateApply },
+  { NULL, NULL }
+};
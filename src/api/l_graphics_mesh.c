@@ -83,7 +83,7 @@ static int l_lovrMeshDraw(lua_State* L) {
   float transform[16];
   int index = luax_readmat4(L, 2, transform, 1);
   int instances = luaL_optinteger(L, index, 1);
-  lovrGraphicsDrawMesh(mesh, transform, instances, NULL);
+  lovrGraphicsDrawMesh(mesh, transform, instances, NULL, 0, 0);
   return 0;
 }
 
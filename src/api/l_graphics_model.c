@@ -4,7 +4,7 @@
 #include "data/modelData.h"
 #include "core/maf.h"
 
-static uint32_t luax_checkanimation(lua_State* L, int index, Model* model) {
+uint32_t luax_checkanimation(lua_State* L, int index, Model* model) {
   switch (lua_type(L, index)) {
     case LUA_TSTRING: {
       size_t length;
@@ -30,6 +30,14 @@ static int l_lovrModelDraw(lua_State* L) {
 
 static int l_lovrModelAnimate(lua_State* L) {
   Model* model = luax_checktype(L, 1, Model);
+
+  AnimationState* state = luax_totype(L, 2, AnimationState);
+  if (state) {
+    float alpha = luax_optfloat(L, 3, 1.f);
+    lovrModelApplyAnimation(model, state, alpha);
+    return 0;
+  }
+
   uint32_t animation = luax_checkanimation(L, 2, model);
   float time = luaL_checknumber(L, 3);
   float alpha = luax_optfloat(L, 4, 1.f);
@@ -3,6 +3,8 @@
 #include "math/curve.h"
 #include "math/pool.h"
 #include "math/randomGenerator.h"
+#include "data/blob.h"
+#include "data/textureData.h"
 #include "core/maf.h"
 #include "core/ref.h"
 #include "core/util.h"
@@ -10,6 +12,7 @@
 
 int l_lovrRandomGeneratorRandom(lua_State* L);
 int l_lovrRandomGeneratorRandomNormal(lua_State* L);
+int l_lovrRandomGeneratorFill(lua_State* L);
 int l_lovrRandomGeneratorGetSeed(lua_State* L);
 int l_lovrRandomGeneratorSetSeed(lua_State* L);
 int l_lovrVec2Set(lua_State* L);
@@ -18,6 +21,14 @@ int l_lovrVec4Set(lua_State* L);
 int l_lovrQuatSet(lua_State* L);
 int l_lovrMat4Set(lua_State* L);
 
+StringEntry lovrRandomDistribution[] = {
+  [RANDOM_UNIFORM] = ENTRY("uniform"),
+  [RANDOM_NORMAL] = ENTRY("normal"),
+  [RANDOM_IN_SPHERE] = ENTRY("insphere"),
+  [RANDOM_ON_SPHERE] = ENTRY("onsphere"),
+  { 0 }
+};
+
 static LOVR_THREAD_LOCAL Pool* pool;
 
 static const luaL_Reg* lovrVectorMetatables[] = {
@@ -155,6 +166,80 @@ static int l_lovrMathNoise(lua_State* L) {
   }
 }
 
+// Reads a field that's either a number (used for every axis) or a table of up to 3 numbers
+static void luax_readnoisefield(lua_State* L, int index, const char* key, float* v, float fallback) {
+  lua_getfield(L, index, key);
+  if (lua_istable(L, -1)) {
+    for (int i = 0; i < 3; i++) {
+      lua_rawgeti(L, -1, i + 1);
+      v[i] = luax_optfloat(L, -1, fallback);
+      lua_pop(L, 1);
+    }
+  } else {
+    float x = luax_optfloat(L, -1, fallback);
+    v[0] = v[1] = v[2] = x;
+  }
+  lua_pop(L, 1);
+}
+
+static int l_lovrMathFillNoise(lua_State* L) {
+  TextureData* textureData = luax_totype(L, 1, TextureData);
+  Blob* blob = textureData ? NULL : luax_checktype(L, 1, Blob);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  uint32_t width, height, depth;
+
+  if (textureData) {
+    width = textureData->width;
+    height = textureData->height;
+    depth = 1;
+  } else {
+    lua_getfield(L, 2, "width");
+    width = luaL_checkinteger(L, -1);
+    lua_getfield(L, 2, "height");
+    height = luaL_optinteger(L, -1, 1);
+    lua_getfield(L, 2, "depth");
+    depth = luaL_optinteger(L, -1, 1);
+    lua_pop(L, 3);
+    lovrAssert(!blob->parent, "Blob views are read only");
+    lovrAssert(blob->size >= (size_t) width * height * depth * sizeof(float), "Blob is too small to hold %dx%dx%d noise samples", width, height, depth);
+  }
+
+  NoiseInfo info;
+  luax_readnoisefield(L, 2, "origin", info.origin, 0.f);
+  luax_readnoisefield(L, 2, "spacing", info.spacing, 1.f);
+  lua_getfield(L, 2, "octaves");
+  lua_Integer octaves = luaL_optinteger(L, -1, 1);
+  lovrAssert(octaves >= 1, "Noise needs at least one octave");
+  info.octaves = (uint32_t) MIN(octaves, UINT32_MAX);
+  lua_getfield(L, 2, "lacunarity");
+  info.lacunarity = luax_optfloat(L, -1, 2.f);
+  lua_getfield(L, 2, "gain");
+  info.gain = luax_optfloat(L, -1, .5f);
+  lua_getfield(L, 2, "dimensions");
+  info.dimensions = luaL_optinteger(L, -1, depth > 1 ? 3 : 2);
+  lua_pop(L, 4);
+
+  if (blob) {
+    lovrMathFillNoise(blob->data, width, height, depth, &info);
+    return 0;
+  }
+
+  TextureFormat format = textureData->format;
+  bool supported = format == FORMAT_RGB || format == FORMAT_RGBA || format == FORMAT_RGBA32F || format == FORMAT_R32F || format == FORMAT_RG32F;
+  lovrAssert(supported && textureData->blob->data, "Unsupported TextureData for noise");
+  float* samples = malloc((size_t) width * height * sizeof(float));
+  lovrAssert(samples, "Out of memory");
+  lovrMathFillNoise(samples, width, height, 1, &info);
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      float v = samples[y * width + x];
+      lovrTextureDataSetPixel(textureData, x, y, (Color) { v, v, v, 1.f });
+    }
+  }
+  free(samples);
+  return 0;
+}
+
 static int l_lovrMathRandom(lua_State* L) {
   luax_pushtype(L, RandomGenerator, lovrMathGetRandomGenerator());
   lua_insert(L, 1);
@@ -167,6 +252,12 @@ static int l_lovrMathRandomNormal(lua_State* L) {
   return l_lovrRandomGeneratorRandomNormal(L);
 }
 
+static int l_lovrMathFillRandom(lua_State* L) {
+  luax_pushtype(L, RandomGenerator, lovrMathGetRandomGenerator());
+  lua_insert(L, 1);
+  return l_lovrRandomGeneratorFill(L);
+}
+
 static int l_lovrMathGetRandomSeed(lua_State* L) {
   luax_pushtype(L, RandomGenerator, lovrMathGetRandomGenerator());
   lua_insert(L, 1);
@@ -278,12 +369,144 @@ static int l_lovrMathDrain(lua_State* L) {
   return 0;
 }
 
+// Copies a vector into the persistent pool, where it stays until lovr.math.free is called on it
+static int l_lovrMathPersist(lua_State* L) {
+  VectorType type;
+  float* v = luax_tovector(L, 1, &type);
+  lovrAssert(v, "Expected a vector");
+  float* data;
+  Vector vector = lovrPoolAllocatePersistent(pool, type, &data);
+  memcpy(data, v, (type == V_MAT4 ? 16 : (type == V_VEC2 ? 2 : 4)) * sizeof(float));
+  lua_pushlightuserdata(L, vector.pointer);
+  return 1;
+}
+
+static int l_lovrMathFree(lua_State* L) {
+  Vector vector = { .pointer = lua_touserdata(L, 1) };
+  bool persistent = lua_type(L, 1) == LUA_TLIGHTUSERDATA && vector.handle.type > V_NONE && vector.handle.type < MAX_VECTOR_TYPES && vector.handle.persistent;
+  lovrAssert(persistent, "Expected a persistent vector");
+  lovrPoolFree(pool, vector);
+  return 0;
+}
+
+// Array functions treat Blobs as tightly packed floats.  Results are written to the first Blob.
+static float* luax_checkarray(lua_State* L, int index, size_t components, size_t* count, bool writable) {
+  Blob* blob = luax_checktype(L, index, Blob);
+  lovrAssert(components >= 1 && components <= 4, "Array vectors must have between 1 and 4 components");
+  lovrAssert(!writable || !blob->parent, "Blob views are read only");
+  lovrAssert(blob->size % (components * sizeof(float)) == 0, "Blob size must be a multiple of the vector size (%d bytes)", (int) (components * sizeof(float)));
+  *count = blob->size / (components * sizeof(float));
+  return blob->data;
+}
+
+static const float* luax_checkotherarray(lua_State* L, int index, size_t components, size_t count) {
+  size_t otherCount;
+  const float* data = luax_checkarray(L, index, components, &otherCount, false);
+  lovrAssert(otherCount >= count, "Blobs need to have the same number of vectors (got %d and %d)", (int) count, (int) otherCount);
+  return data;
+}
+
+static int l_lovrMathTransformArray(lua_State* L) {
+  size_t count, components = luaL_optinteger(L, 3, 3);
+  float* points = luax_checkarray(L, 1, components, &count, true);
+  float* transform = luax_checkvector(L, 2, V_MAT4, NULL);
+  lovrMathTransformArray(points, count, components, transform);
+  return 0;
+}
+
+static int l_lovrMathNormalizeArray(lua_State* L) {
+  size_t count, components = luaL_optinteger(L, 2, 3);
+  float* vectors = luax_checkarray(L, 1, components, &count, true);
+  lovrMathNormalizeArray(vectors, count, components);
+  return 0;
+}
+
+static int l_lovrMathLerpArray(lua_State* L) {
+  size_t count;
+  float* a = luax_checkarray(L, 1, 1, &count, true);
+  const float* b = luax_checkotherarray(L, 2, 1, count);
+  float t = luax_checkfloat(L, 3);
+  lovrMathCombineArrays(a, b, count, 1, ARRAY_LERP, t);
+  return 0;
+}
+
+static int l_lovrMathMinArray(lua_State* L) {
+  size_t count;
+  float* a = luax_checkarray(L, 1, 1, &count, true);
+  const float* b = luax_checkotherarray(L, 2, 1, count);
+  lovrMathCombineArrays(a, b, count, 1, ARRAY_MIN, 0.f);
+  return 0;
+}
+
+static int l_lovrMathMaxArray(lua_State* L) {
+  size_t count;
+  float* a = luax_checkarray(L, 1, 1, &count, true);
+  const float* b = luax_checkotherarray(L, 2, 1, count);
+  lovrMathCombineArrays(a, b, count, 1, ARRAY_MAX, 0.f);
+  return 0;
+}
+
+static int l_lovrMathDotArray(lua_State* L) {
+  size_t count, components = luaL_optinteger(L, 3, 3);
+  const float* a = luax_checkarray(L, 1, components, &count, false);
+  const float* b = luax_checkotherarray(L, 2, components, count);
+  size_t size = count * sizeof(float);
+
+  Blob* blob = luax_totype(L, 4, Blob);
+  if (blob) {
+    lovrAssert(!blob->parent, "Blob views are read only");
+    lovrAssert(blob->size >= size, "Blob is too small to hold %d dot products", (int) count);
+    lua_settop(L, 4);
+  } else {
+    void* data = malloc(MAX(size, 1));
+    lovrAssert(data, "Out of memory");
+    blob = lovrBlobCreate(data, size, "Dot products");
+    luax_pushtype(L, Blob, blob);
+    lovrRelease(Blob, blob);
+  }
+
+  lovrMathDotArrays(blob->data, a, b, count, components);
+  return 1;
+}
+
+static int l_lovrMathCrossArray(lua_State* L) {
+  size_t count, components = luaL_optinteger(L, 3, 3);
+  float* a = luax_checkarray(L, 1, components, &count, true);
+  const float* b = luax_checkotherarray(L, 2, components, count);
+  lovrMathCrossArrays(a, b, count, components);
+  return 0;
+}
+
+static int l_lovrMathSumArray(lua_State* L) {
+  size_t count, components = luaL_optinteger(L, 2, 3);
+  const float* vectors = luax_checkarray(L, 1, components, &count, false);
+  float sum[4];
+  lovrMathSumArray(vectors, count, components, sum);
+  for (size_t i = 0; i < components; i++) {
+    lua_pushnumber(L, sum[i]);
+  }
+  return (int) components;
+}
+
+static int l_lovrMathGetArrayBounds(lua_State* L) {
+  size_t count, components = luaL_optinteger(L, 2, 3);
+  const float* points = luax_checkarray(L, 1, components, &count, false);
+  float aabb[6];
+  lovrMathGetArrayBounds(points, count, components, aabb);
+  for (int i = 0; i < 6; i++) {
+    lua_pushnumber(L, aabb[i]);
+  }
+  return 6;
+}
+
 static const luaL_Reg lovrMath[] = {
   { "newCurve", l_lovrMathNewCurve },
   { "newRandomGenerator", l_lovrMathNewRandomGenerator },
   { "noise", l_lovrMathNoise },
+  { "fillNoise", l_lovrMathFillNoise },
   { "random", l_lovrMathRandom },
   { "randomNormal", l_lovrMathRandomNormal },
+  { "fillRandom", l_lovrMathFillRandom },
   { "getRandomSeed", l_lovrMathGetRandomSeed },
   { "setRandomSeed", l_lovrMathSetRandomSeed },
   { "gammaToLinear", l_lovrMathGammaToLinear },
@@ -299,6 +522,17 @@ static const luaL_Reg lovrMath[] = {
   { "quat", l_lovrMathQuat },
   { "mat4", l_lovrMathMat4 },
   { "drain", l_lovrMathDrain },
+  { "persist", l_lovrMathPersist },
+  { "free", l_lovrMathFree },
+  { "transformArray", l_lovrMathTransformArray },
+  { "normalizeArray", l_lovrMathNormalizeArray },
+  { "lerpArray", l_lovrMathLerpArray },
+  { "minArray", l_lovrMathMinArray },
+  { "maxArray", l_lovrMathMaxArray },
+  { "dotArray", l_lovrMathDotArray },
+  { "crossArray", l_lovrMathCrossArray },
+  { "sumArray", l_lovrMathSumArray },
+  { "getArrayBounds", l_lovrMathGetArrayBounds },
   { NULL, NULL }
 };
 
@@ -383,15 +617,18 @@ int luaopen_lovr_math(lua_State* L) {
     luax_atexit(L, lovrMathDestroy);
   }
 
-  // Each Lua state gets its own thread-local Pool
-  pool = lovrPoolCreate();
-  luax_atexit(L, luax_destroypool);
-
-  // Globals
+  // Globals and pool size
+  size_t poolSize = 1 << 20;
   luax_pushconf(L);
   if (lua_istable(L, -1)) {
     lua_getfield(L, -1, "math");
     if (lua_istable(L, -1)) {
+      lua_getfield(L, -1, "poolsize");
+      if (lua_type(L, -1) == LUA_TNUMBER) {
+        poolSize = MAX(lua_tointeger(L, -1), 0);
+      }
+      lua_pop(L, 1);
+
       lua_getfield(L, -1, "globals");
       if (lua_toboolean(L, -1)) {
         for (size_t i = V_NONE + 1; i < MAX_VECTOR_TYPES; i++) {
@@ -405,5 +642,9 @@ int luaopen_lovr_math(lua_State* L) {
   }
   lua_pop(L, 1);
 
+  // Each Lua state gets its own thread-local Pool, the size is in bytes
+  pool = lovrPoolCreate(MAX(poolSize / sizeof(float), 16));
+  luax_atexit(L, luax_destroypool);
+
   return 1;
 }
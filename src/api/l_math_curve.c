@@ -1,11 +1,15 @@
 #include "api.h"
 #include "math/curve.h"
+#include "data/blob.h"
 #include "core/util.h"
 #include <stdlib.h>
 
 static int l_lovrCurveEvaluate(lua_State* L) {
   Curve* curve = luax_checktype(L, 1, Curve);
   float t = luax_checkfloat(L, 2);
+  if (lua_toboolean(L, 3)) {
+    t = lovrCurveGetUniformParameter(curve, t);
+  }
   float point[4];
   lovrCurveEvaluate(curve, t, point);
   lua_pushnumber(L, point[0]);
@@ -30,21 +34,37 @@ static int l_lovrCurveRender(lua_State* L) {
   int n = luaL_optinteger(L, 2, 32);
   float t1 = luax_optfloat(L, 3, 0.);
   float t2 = luax_optfloat(L, 4, 1.);
-  if (lovrCurveGetPointCount(curve) == 2) {
+  bool uniform = lua_toboolean(L, 6);
+  if (lovrCurveGetPointCount(curve) == 2 && !uniform) {
     n = 2;
   }
+  lovrAssert(n > 0, "Curve must be rendered with at least 1 point");
+
+  // Points are written as 3 floats each when a Blob is given
+  Blob* blob = luax_totype(L, 5, Blob);
+  if (blob) {
+    lovrAssert(!blob->parent, "Blob views are read only");
+    lovrAssert(blob->size >= n * 3 * sizeof(float), "Blob is too small to hold %d points", n);
+    lovrCurveRender(curve, t1, t2, blob->data, n, uniform);
+    lua_settop(L, 5);
+    return 1;
+  }
+
+  float* points = malloc(n * 3 * sizeof(float));
+  lovrAssert(points, "Out of memory");
+  lovrCurveRender(curve, t1, t2, points, n, uniform);
   lua_createtable(L, n * 3, 0);
-  float step = 1.f / (n - 1);
-  for (int i = 0; i < n; i++) {
-    float point[4];
-    lovrCurveEvaluate(curve, t1 + (t2 - t1) * i * step, point);
-    lua_pushnumber(L, point[0]);
-    lua_rawseti(L, -2, 3 * i + 1);
-    lua_pushnumber(L, point[1]);
-    lua_rawseti(L, -2, 3 * i + 2);
-    lua_pushnumber(L, point[2]);
-    lua_rawseti(L, -2, 3 * i + 3);
+  for (int i = 0; i < n * 3; i++) {
+    lua_pushnumber(L, points[i]);
+    lua_rawseti(L, -2, i + 1);
   }
+  free(points);
+  return 1;
+}
+
+static int l_lovrCurveGetLength(lua_State* L) {
+  Curve* curve = luax_checktype(L, 1, Curve);
+  lua_pushnumber(L, lovrCurveGetLength(curve));
   return 1;
 }
 
@@ -107,6 +127,7 @@ const luaL_Reg lovrCurve[] = {
   { "evaluate", l_lovrCurveEvaluate },
   { "getTangent", l_lovrCurveGetTangent },
   { "render", l_lovrCurveRender },
+  { "getLength", l_lovrCurveGetLength },
   { "slice", l_lovrCurveSlice },
   { "getPointCount", l_lovrCurveGetPointCount },
   { "getPoint", l_lovrCurveGetPoint },
@@ -1,5 +1,6 @@
 #include "api.h"
 #include "math/randomGenerator.h"
+#include "data/blob.h"
 #include <math.h>
 
 static double luax_checkrandomseedpart(lua_State* L, int index) {
@@ -76,6 +77,18 @@ int l_lovrRandomGeneratorRandom(lua_State* L) {
   return 1;
 }
 
+// Fills the whole Blob, sphere samples are 3 floats each and other samples are single floats
+int l_lovrRandomGeneratorFill(lua_State* L) {
+  RandomGenerator* generator = luax_checktype(L, 1, RandomGenerator);
+  Blob* blob = luax_checktype(L, 2, Blob);
+  RandomDistribution distribution = luax_checkenum(L, 3, RandomDistribution, "uniform");
+  size_t stride = (distribution == RANDOM_IN_SPHERE || distribution == RANDOM_ON_SPHERE ? 3 : 1) * sizeof(float);
+  lovrAssert(!blob->parent, "Blob views are read only");
+  lovrAssert(blob->size % stride == 0, "Blob size must be a multiple of the sample size (%d bytes)", (int) stride);
+  lovrRandomGeneratorFill(generator, blob->data, blob->size / stride, distribution);
+  return 0;
+}
+
 int l_lovrRandomGeneratorRandomNormal(lua_State* L) {
   RandomGenerator* generator = luax_checktype(L, 1, RandomGenerator);
   float sigma = luax_optfloat(L, 2, 1.f);
@@ -91,5 +104,6 @@ const luaL_Reg lovrRandomGenerator[] = {
   { "setState", l_lovrRandomGeneratorSetState },
   { "random", l_lovrRandomGeneratorRandom },
   { "randomNormal", l_lovrRandomGeneratorRandomNormal },
+  { "fill", l_lovrRandomGeneratorFill },
   { NULL, NULL }
 };
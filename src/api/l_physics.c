@@ -1,7 +1,22 @@
 #include "api.h"
 #include "physics/physics.h"
+#include "data/blob.h"
 #include "core/ref.h"
 
+StringEntry lovrBroadphaseType[] = {
+  [BROADPHASE_HASH] = ENTRY("hash"),
+  [BROADPHASE_SAP] = ENTRY("sap"),
+  [BROADPHASE_QUADTREE] = ENTRY("quadtree"),
+  [BROADPHASE_SIMPLE] = ENTRY("simple"),
+  { 0 }
+};
+
+StringEntry lovrPoseFormat[] = {
+  [POSE_COMPACT] = ENTRY("pose"),
+  [POSE_MATRIX] = ENTRY("matrix"),
+  { 0 }
+};
+
 StringEntry lovrShapeType[] = {
   [SHAPE_SPHERE] = ENTRY("sphere"),
   [SHAPE_BOX] = ENTRY("box"),
@@ -40,12 +55,80 @@ static int l_lovrPhysicsNewWorld(lua_State* L) {
   } else {
     tagCount = 0;
   }
-  World* world = lovrWorldCreate(xg, yg, zg, allowSleep, tags, tagCount);
+  WorldFlags flags = {
+    .broadphase = BROADPHASE_HASH,
+    .size = { 256.f, 256.f, 256.f },
+    .cellSize = 1.f / 16.f,
+    .depth = 5
+  };
+  if (lua_istable(L, 6)) {
+    lua_getfield(L, 6, "broadphase");
+    flags.broadphase = luax_checkenum(L, -1, BroadphaseType, "hash");
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "tagSpaces");
+    flags.tagSpaces = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "staticSpace");
+    flags.staticSpace = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "center");
+    if (lua_istable(L, -1)) {
+      for (int i = 0; i < 3; i++) {
+        lua_rawgeti(L, -1, i + 1);
+        flags.center[i] = luax_optfloat(L, -1, 0.f);
+        lua_pop(L, 1);
+      }
+    }
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "size");
+    if (lua_type(L, -1) == LUA_TNUMBER) {
+      flags.size[0] = flags.size[1] = flags.size[2] = luax_checkfloat(L, -1);
+    } else if (lua_istable(L, -1)) {
+      for (int i = 0; i < 3; i++) {
+        lua_rawgeti(L, -1, i + 1);
+        flags.size[i] = luax_optfloat(L, -1, flags.size[i]);
+        lua_pop(L, 1);
+      }
+    }
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "cellSize");
+    flags.cellSize = luax_optfloat(L, -1, flags.cellSize);
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "depth");
+    lua_Integer depth = luaL_optinteger(L, -1, flags.depth);
+    lovrAssert(depth >= 1 && depth <= MAX_QUADTREE_DEPTH, "World depth must be between 1 and %d", MAX_QUADTREE_DEPTH);
+    flags.depth = depth;
+    lua_pop(L, 1);
+
+    lua_getfield(L, 6, "workers");
+    lua_Integer workers = luaL_optinteger(L, -1, 0);
+    lovrAssert(workers >= 0, "Worker count can not be negative");
+    flags.workers = workers;
+    lua_pop(L, 1);
+
+    lovrAssert(flags.cellSize > 0.f && flags.size[0] > 0.f && flags.size[1] > 0.f && flags.size[2] > 0.f, "World size hints must be positive");
+  }
+  World* world = lovrWorldCreate(xg, yg, zg, allowSleep, tags, tagCount, flags);
   luax_pushtype(L, World, world);
   lovrRelease(World, world);
   return 1;
 }
 
+static int l_lovrPhysicsCookMesh(lua_State* L) {
+  TriMesh* trimesh = luax_checktrimesh(L, 1);
+  Blob* blob = lovrTriMeshCook(trimesh->vertices, trimesh->vertexCount, trimesh->indices, trimesh->indexCount);
+  lovrRelease(TriMesh, trimesh);
+  luax_pushtype(L, Blob, blob);
+  lovrRelease(Blob, blob);
+  return 1;
+}
+
 static int l_lovrPhysicsNewBallJoint(lua_State* L) {
   Collider* a = luax_checktype(L, 1, Collider);
   Collider* b = luax_checktype(L, 2, Collider);
@@ -120,6 +203,15 @@ static int l_lovrPhysicsNewSliderJoint(lua_State* L) {
   return 1;
 }
 
+static int l_lovrPhysicsNewMeshShape(lua_State* L) {
+  TriMesh* trimesh = luax_checktrimesh(L, 1);
+  MeshShape* mesh = lovrMeshShapeCreate(trimesh);
+  luax_pushtype(L, MeshShape, mesh);
+  lovrRelease(Shape, mesh);
+  lovrRelease(TriMesh, trimesh);
+  return 1;
+}
+
 static int l_lovrPhysicsNewSphereShape(lua_State* L) {
   float radius = luax_optfloat(L, 1, 1.f);
   SphereShape* sphere = lovrSphereShapeCreate(radius);
@@ -137,7 +229,9 @@ static const luaL_Reg lovrPhysics[] = {
   { "newDistanceJoint", l_lovrPhysicsNewDistanceJoint },
   { "newHingeJoint", l_lovrPhysicsNewHingeJoint },
   { "newSliderJoint", l_lovrPhysicsNewSliderJoint },
+  { "newMeshShape", l_lovrPhysicsNewMeshShape },
   { "newSphereShape", l_lovrPhysicsNewSphereShape },
+  { "cookMesh", l_lovrPhysicsCookMesh },
   { NULL, NULL }
 };
 
@@ -227,15 +227,15 @@ static int l_lovrColliderSetOrientation(lua_State* L) {
   return 0;
 }
 
+// In a World with a fixed timestep, the pose is interpolated between the last two steps
 static int l_lovrColliderGetPose(lua_State* L) {
   Collider* collider = luax_checktype(L, 1, Collider);
-  float x, y, z, angle, ax, ay, az, orientation[4];
-  lovrColliderGetPosition(collider, &x, &y, &z);
-  lovrColliderGetOrientation(collider, orientation);
+  float position[4], orientation[4], angle, ax, ay, az;
+  lovrColliderGetInterpolatedPose(collider, position, orientation);
   quat_getAngleAxis(orientation, &angle, &ax, &ay, &az);
-  lua_pushnumber(L, x);
-  lua_pushnumber(L, y);
-  lua_pushnumber(L, z);
+  lua_pushnumber(L, position[0]);
+  lua_pushnumber(L, position[1]);
+  lua_pushnumber(L, position[2]);
   lua_pushnumber(L, angle);
   lua_pushnumber(L, ax);
   lua_pushnumber(L, ay);
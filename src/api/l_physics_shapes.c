@@ -1,5 +1,8 @@
 #include "api.h"
 #include "physics/physics.h"
+#include "data/blob.h"
+#include "core/ref.h"
+#include <stdlib.h>
 
 void luax_pushshape(lua_State* L, Shape* shape) {
   switch (shape->type) {
@@ -35,6 +38,75 @@ Shape* luax_checkshape(lua_State* L, int index) {
   return NULL;
 }
 
+// A TriMesh can come from cooked data in a Blob, from another MeshShape (sharing its TriMesh), or
+// from a table of vertices ({ x, y, z } tables) and a table of 1-based indices.  The TriMesh is
+// returned with a reference the caller has to release.
+TriMesh* luax_checktrimesh(lua_State* L, int index) {
+  Blob* blob = luax_totype(L, index, Blob);
+  if (blob) {
+    return lovrTriMeshCreateFromBlob(blob);
+  }
+
+  MeshShape* shape = luax_totype(L, index, MeshShape);
+  if (shape) {
+    TriMesh* trimesh = lovrMeshShapeGetTriMesh(shape);
+    lovrAssert(trimesh, "MeshShape has been destroyed");
+    lovrRetain(trimesh);
+    return trimesh;
+  }
+
+  luaL_checktype(L, index, LUA_TTABLE);
+  luaL_checktype(L, index + 1, LUA_TTABLE);
+  uint32_t vertexCount = luax_len(L, index);
+  uint32_t indexCount = luax_len(L, index + 1);
+  lovrAssert(indexCount % 3 == 0, "TriMesh index count must be a multiple of 3");
+
+  // The tables are checked before anything is allocated, so errors don't leak the arrays
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    lua_rawgeti(L, index, i + 1);
+    lovrAssert(lua_istable(L, -1), "Each vertex must be a table of coordinates");
+    for (int j = 0; j < 3; j++) {
+      lua_rawgeti(L, -1, j + 1);
+      luaL_optnumber(L, -1, 0.);
+      lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+  }
+
+  for (uint32_t i = 0; i < indexCount; i++) {
+    lua_rawgeti(L, index + 1, i + 1);
+    lua_Integer vertex = luaL_checkinteger(L, -1);
+    lovrAssert(vertex > 0 && vertex <= vertexCount, "Invalid vertex index %d", (int) vertex);
+    lua_pop(L, 1);
+  }
+
+  float* vertices = malloc(sizeof(float) * vertexCount * 3);
+  dTriIndex* indices = malloc(sizeof(dTriIndex) * indexCount);
+  if (!vertices || !indices) {
+    free(vertices);
+    free(indices);
+    lovrThrow("Out of memory");
+  }
+
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    lua_rawgeti(L, index, i + 1);
+    for (int j = 0; j < 3; j++) {
+      lua_rawgeti(L, -1, j + 1);
+      vertices[i * 3 + j] = lua_tonumber(L, -1);
+      lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+  }
+
+  for (uint32_t i = 0; i < indexCount; i++) {
+    lua_rawgeti(L, index + 1, i + 1);
+    indices[i] = lua_tointeger(L, -1) - 1;
+    lua_pop(L, 1);
+  }
+
+  return lovrTriMeshCreate(vertices, vertexCount, indices, indexCount);
+}
+
 static int l_lovrShapeDestroy(lua_State* L) {
   Shape* shape = luax_checkshape(L, 1);
   lovrShapeDestroyData(shape);
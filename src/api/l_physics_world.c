@@ -1,6 +1,8 @@
 #include "api.h"
 #include "physics/physics.h"
+#include "data/blob.h"
 #include "core/ref.h"
+#include <stdlib.h>
 #include <stdbool.h>
 
 static void collisionResolver(World* world, void* userdata) {
@@ -38,6 +40,90 @@ static void raycastCallback(Shape* shape, float x, float y, float z, float nx, f
   lua_call(L, 7, 0);
 }
 
+// Queries are a Blob of floats or a flat table of numbers.  Each query gets maxHits slots in the
+// result Blob, 8 floats each: the hit position, the normal, the distance, and 1 for a hit or 0 for
+// an empty slot.  Hits are sorted by distance.  If a table is given, slot i is set to the Shape
+// that was hit (or false).  Returns the result Blob and the total number of hits.
+static int luax_querymany(lua_State* L, World* world, QueryType type, int index) {
+  static const uint32_t strides[] = { [QUERY_RAY] = 6, [QUERY_SPHERE] = 7, [QUERY_BOX] = 9 };
+  uint32_t stride = strides[type];
+  float* queries = NULL;
+  const float* data = NULL;
+  Blob* blob = NULL;
+  uint32_t count;
+
+  if (lua_istable(L, index)) {
+    count = luax_len(L, index) / stride;
+  } else {
+    blob = luax_checktype(L, index, Blob);
+    count = blob->size / (stride * sizeof(float));
+    data = blob->data;
+  }
+
+  uint32_t maxHits = luaL_optinteger(L, index + 2, 1);
+  lovrAssert(maxHits > 0, "Queries need room for at least one hit");
+  size_t size = count * maxHits * 8 * sizeof(float);
+
+  Blob* results = luax_totype(L, index + 1, Blob);
+  if (results) {
+    lovrAssert(!results->parent, "Query results can not be written to a Blob view");
+    lovrAssert(results->size >= size, "Result Blob is too small (needs %zu bytes, got %zu)", size, results->size);
+    lua_pushvalue(L, index + 1);
+  } else {
+    void* resultData = malloc(size);
+    lovrAssert(resultData, "Out of memory");
+    results = lovrBlobCreate(resultData, size, "Query results");
+    luax_pushtype(L, Blob, results);
+    lovrRelease(Blob, results);
+  }
+
+  // Everything that can throw is checked before the temporary arrays are allocated
+  RaycastHit* hits = malloc(count * maxHits * sizeof(RaycastHit));
+  lovrAssert(hits, "Out of memory");
+
+  if (!blob) {
+    queries = malloc(count * stride * sizeof(float));
+    if (!queries) {
+      free(hits);
+      lovrThrow("Out of memory");
+    }
+
+    for (uint32_t i = 0; i < count * stride; i++) {
+      lua_rawgeti(L, index, i + 1);
+      queries[i] = (float) lua_tonumber(L, -1);
+      lua_pop(L, 1);
+    }
+    data = queries;
+  }
+
+  uint32_t total = lovrWorldQueryMany(world, type, data, count, hits, NULL, maxHits);
+  free(queries);
+
+  float* result = results->data;
+  for (uint32_t i = 0; i < count * maxHits; i++, result += 8) {
+    RaycastHit* hit = &hits[i];
+    memcpy(result + 0, hit->position, 3 * sizeof(float));
+    memcpy(result + 3, hit->normal, 3 * sizeof(float));
+    result[6] = hit->distance;
+    result[7] = hit->shape ? 1.f : 0.f;
+  }
+
+  if (lua_istable(L, index + 3)) {
+    for (uint32_t i = 0; i < count * maxHits; i++) {
+      if (hits[i].shape) {
+        luax_pushshape(L, hits[i].shape);
+      } else {
+        lua_pushboolean(L, false);
+      }
+      lua_rawseti(L, index + 3, i + 1);
+    }
+  }
+
+  free(hits);
+  lua_pushinteger(L, total);
+  return 2;
+}
+
 static int l_lovrWorldNewCollider(lua_State* L) {
   World* world = luax_checktype(L, 1, World);
   float position[4];
@@ -112,39 +198,15 @@ static int l_lovrWorldNewSphereCollider(lua_State* L) {
 
 static int l_lovrWorldNewMeshCollider(lua_State* L) {
   World* world = luax_checktype(L, 1, World);
-  lovrAssert(lua_istable(L, 2), "Vertices must be a table");
-  lovrAssert(lua_istable(L, 3), "Indices must be a table");
-  int vertexCount = luax_len(L, 2);
-  int indexCount  = luax_len(L, 3);
-  // TODO: this never gets deallocated
-  float    * vertices = malloc(sizeof(float) * vertexCount * 3);
-  unsigned * indices  = malloc(sizeof(unsigned) * indexCount);
-
-  for (int i = 0; i < vertexCount; i++) {
-    lua_rawgeti(L, 2, i + 1);
-    lovrAssert(lua_istable(L, -1), "Each verticle must be a table of coordinates");
-    lua_rawgeti(L, -1, 1); // x
-    vertices[i * 3 + 0] = luaL_optnumber(L, -1, 0.);
-    lua_pop(L, 1);
-    lua_rawgeti(L, -1, 2); // y
-    vertices[i * 3 + 1] = luaL_optnumber(L, -1, 0.);
-    lua_pop(L, 1);
-    lua_rawgeti(L, -1, 3); // z
-    vertices[i * 3 + 2] = luaL_optnumber(L, -1, 0.);
-    lua_pop(L, 2);
-  }
-  for (int i = 0; i < indexCount; i++) {
-    lua_rawgeti(L, 3, i + 1);
-    indices[i] = luaL_checkinteger(L, -1) - 1;
-  }
-  lua_pop(L, indexCount);
+  TriMesh* trimesh = luax_checktrimesh(L, 2);
   Collider* collider = lovrColliderCreate(world, 0,0,0);
-  MeshShape* shape = lovrMeshShapeCreate(vertexCount, vertices, indexCount, indices);
+  MeshShape* shape = lovrMeshShapeCreate(trimesh);
   lovrColliderAddShape(collider, shape);
   lovrColliderInitInertia(collider, shape);
   luax_pushtype(L, Collider, collider);
   lovrRelease(Collider, collider);
   lovrRelease(Shape, shape);
+  lovrRelease(TriMesh, trimesh);
   return 1;
 }
 
@@ -157,18 +219,41 @@ static int l_lovrWorldGetColliders(lua_State* L) {
     lua_newtable(L);
   }
 
-  Collider* collider = lovrWorldGetFirstCollider(world);
-  int index = 1;
-
-  while (collider) {
-    luax_pushtype(L, Collider, collider);
-    lua_rawseti(L, -2, index++);
-    collider = collider->next;
+  size_t count;
+  Collider** colliders = lovrWorldGetColliders(world, &count);
+  for (size_t i = 0; i < count; i++) {
+    luax_pushtype(L, Collider, colliders[i]);
+    lua_rawseti(L, -2, i + 1);
   }
 
   return 1;
 }
 
+static int l_lovrWorldGetPoses(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  PoseFormat format = luax_checkenum(L, 3, PoseFormat, "pose");
+  bool awakeOnly = lua_toboolean(L, 4);
+  size_t count;
+  lovrWorldGetColliders(world, &count);
+  size_t size = count * (format == POSE_MATRIX ? 16 : 8) * sizeof(float);
+
+  Blob* blob = luax_totype(L, 2, Blob);
+  if (blob) {
+    lovrAssert(!blob->parent, "Poses can not be written to a Blob view");
+    lovrAssert(blob->size >= size, "Blob is too small to hold %d poses (needs %zu bytes, got %zu)", (int) count, size, blob->size);
+    lua_settop(L, 2);
+  } else {
+    void* data = calloc(1, MAX(size, 1));
+    lovrAssert(data, "Out of memory");
+    blob = lovrBlobCreate(data, size, "Poses");
+    luax_pushtype(L, Blob, blob);
+    lovrRelease(Blob, blob);
+  }
+
+  lua_pushinteger(L, lovrWorldGetPoses(world, blob->data, format, awakeOnly));
+  return 2;
+}
+
 static int l_lovrWorldDestroy(lua_State* L) {
   World* world = luax_checktype(L, 1, World);
   lovrWorldDestroyData(world);
@@ -207,6 +292,130 @@ static int l_lovrWorldCollide(lua_State* L) {
   return 1;
 }
 
+static int l_lovrWorldComputeContacts(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  lua_pushinteger(L, lovrWorldComputeContacts(world));
+  return 1;
+}
+
+static int l_lovrWorldGetContactCount(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  uint32_t count;
+  lovrWorldGetContacts(world, &count);
+  lua_pushinteger(L, count);
+  return 1;
+}
+
+static int l_lovrWorldGetContact(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  uint32_t index = luaL_checkinteger(L, 2) - 1;
+  uint32_t count;
+  Contact* contacts = lovrWorldGetContacts(world, &count);
+  lovrAssert(index < count, "Invalid contact index: %d", index + 1);
+  Contact* contact = &contacts[index];
+  if (!contact->a->collider || !contact->b->collider) {
+    lua_pushnil(L);
+    return 1;
+  }
+  luax_pushshape(L, contact->a);
+  luax_pushshape(L, contact->b);
+  lua_pushnumber(L, contact->position[0]);
+  lua_pushnumber(L, contact->position[1]);
+  lua_pushnumber(L, contact->position[2]);
+  lua_pushnumber(L, contact->normal[0]);
+  lua_pushnumber(L, contact->normal[1]);
+  lua_pushnumber(L, contact->normal[2]);
+  lua_pushnumber(L, contact->depth);
+  return 9;
+}
+
+// Writes the 1-based index of the Shape's Collider in World:getColliders and the index of the Shape
+// in Collider:getShapes, or zeroes if the Shape isn't attached to anything
+static void writeContactShape(Shape* shape, float* data) {
+  Collider* collider = shape->collider;
+  data[0] = data[1] = 0.f;
+
+  if (!collider) {
+    return;
+  }
+
+  size_t count;
+  Shape** shapes = lovrColliderGetShapes(collider, &count);
+  for (size_t i = 0; i < count; i++) {
+    if (shapes[i] == shape) {
+      data[0] = (float) (collider->index + 1);
+      data[1] = (float) (i + 1);
+      return;
+    }
+  }
+}
+
+// Contacts are written to a Blob as 11 floats each: the position, the normal, the depth, and then
+// the Collider and Shape index of both Shapes (see writeContactShape)
+static int l_lovrWorldGetContacts(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  uint32_t count;
+  Contact* contacts = lovrWorldGetContacts(world, &count);
+  size_t size = count * 11 * sizeof(float);
+
+  Blob* blob = luax_totype(L, 2, Blob);
+  if (blob) {
+    lovrAssert(!blob->parent, "Contacts can not be written to a Blob view");
+    lovrAssert(blob->size >= size, "Blob is too small to hold %d contacts (needs %zu bytes, got %zu)", count, size, blob->size);
+    lua_settop(L, 2);
+  } else {
+    void* data = malloc(MAX(size, 1));
+    lovrAssert(data, "Out of memory");
+    blob = lovrBlobCreate(data, size, "Contacts");
+    luax_pushtype(L, Blob, blob);
+    lovrRelease(Blob, blob);
+  }
+
+  float* data = blob->data;
+  for (uint32_t i = 0; i < count; i++, data += 11) {
+    memcpy(data + 0, contacts[i].position, 3 * sizeof(float));
+    memcpy(data + 3, contacts[i].normal, 3 * sizeof(float));
+    data[6] = contacts[i].depth;
+    writeContactShape(contacts[i].a, data + 7);
+    writeContactShape(contacts[i].b, data + 9);
+  }
+
+  lua_pushinteger(L, count);
+  return 2;
+}
+
+static int l_lovrWorldResolveContacts(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  lovrWorldResolveContacts(world);
+  return 0;
+}
+
+static int l_lovrWorldSnapshot(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  size_t size = lovrWorldSnapshot(world, NULL, 0);
+
+  Blob* blob = luax_totype(L, 2, Blob);
+  if (blob && !blob->parent && blob->size >= size) {
+    lua_settop(L, 2);
+  } else {
+    void* data = malloc(size);
+    lovrAssert(data, "Out of memory");
+    blob = lovrBlobCreate(data, size, "World snapshot");
+    luax_pushtype(L, Blob, blob);
+    lovrRelease(Blob, blob);
+  }
+
+  lovrWorldSnapshot(world, blob->data, blob->size);
+  return 1;
+}
+
+static int l_lovrWorldRestore(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  Blob* blob = luax_checktype(L, 2, Blob);
+  lovrWorldRestore(world, blob->data, blob->size);
+  return 0;
+}
+
 static int l_lovrWorldGetGravity(lua_State* L) {
   World* world = luax_checktype(L, 1, World);
   float x, y, z;
@@ -314,6 +523,18 @@ static int l_lovrWorldRaycast(lua_State* L) {
   return 0;
 }
 
+static int l_lovrWorldRaycastMany(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  return luax_querymany(L, world, QUERY_RAY, 2);
+}
+
+static int l_lovrWorldSweepMany(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  ShapeType shape = luax_checkenum(L, 2, ShapeType, NULL);
+  lovrAssert(shape == SHAPE_SPHERE || shape == SHAPE_BOX, "Only spheres and boxes can be swept");
+  return luax_querymany(L, world, shape == SHAPE_SPHERE ? QUERY_SPHERE : QUERY_BOX, 3);
+}
+
 static int l_lovrWorldDisableCollisionBetween(lua_State* L) {
   World* world = luax_checktype(L, 1, World);
   const char* tag1 = luaL_checkstring(L, 2);
@@ -338,6 +559,97 @@ static int l_lovrWorldIsCollisionEnabledBetween(lua_State* L) {
   return 1;
 }
 
+static int l_lovrWorldGetMaterial(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  const char* tag1 = luaL_checkstring(L, 2);
+  const char* tag2 = luaL_checkstring(L, 3);
+  float friction, restitution;
+  lovrAssert(lovrWorldGetMaterial(world, tag1, tag2, &friction, &restitution), "Unknown tag pair '%s' and '%s'", tag1, tag2);
+  if (friction >= 0.f) lua_pushnumber(L, friction); else lua_pushnil(L);
+  if (restitution >= 0.f) lua_pushnumber(L, restitution); else lua_pushnil(L);
+  return 2;
+}
+
+// A nil friction or restitution goes back to using the values from the Colliders
+static int l_lovrWorldSetMaterial(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  const char* tag1 = luaL_checkstring(L, 2);
+  const char* tag2 = luaL_checkstring(L, 3);
+  float friction = luax_optfloat(L, 4, -1.f);
+  float restitution = luax_optfloat(L, 5, -1.f);
+  lovrAssert(lovrWorldSetMaterial(world, tag1, tag2, friction, restitution), "Unknown tag pair '%s' and '%s'", tag1, tag2);
+  return 0;
+}
+
+static int l_lovrWorldGetPairCounts(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  uint32_t tested, accepted;
+  lovrWorldGetPairCounts(world, &tested, &accepted);
+  lua_pushinteger(L, tested);
+  lua_pushinteger(L, accepted);
+  return 2;
+}
+
+static int l_lovrWorldGetCollisionTime(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  lua_pushnumber(L, lovrWorldGetCollisionTime(world));
+  return 1;
+}
+
+static int l_lovrWorldGetTimestep(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  float timestep;
+  uint32_t maxSteps;
+  lovrWorldGetTimestep(world, &timestep, &maxSteps);
+  lua_pushnumber(L, timestep);
+  lua_pushinteger(L, maxSteps);
+  return 2;
+}
+
+static int l_lovrWorldSetTimestep(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  float timestep = luax_optfloat(L, 2, 0.f);
+  lua_Integer maxSteps = luaL_optinteger(L, 3, 4);
+  lovrAssert(timestep >= 0.f, "Timestep can not be negative");
+  lovrAssert(maxSteps >= 1, "World needs to be able to take at least one step per update");
+  lovrWorldSetTimestep(world, timestep, maxSteps);
+  return 0;
+}
+
+static int l_lovrWorldGetIterations(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  lua_pushinteger(L, lovrWorldGetIterations(world));
+  return 1;
+}
+
+static int l_lovrWorldSetIterations(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  uint32_t iterations = luaL_checkinteger(L, 2);
+  lovrAssert(iterations > 0, "Iteration count must be positive");
+  lovrWorldSetIterations(world, iterations);
+  return 0;
+}
+
+static int l_lovrWorldGetInterpolation(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  lua_pushnumber(L, lovrWorldGetInterpolation(world));
+  return 1;
+}
+
+static int l_lovrWorldGetWorkerCount(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  lua_pushinteger(L, lovrWorldGetWorkerCount(world));
+  return 1;
+}
+
+static int l_lovrWorldSetWorkerCount(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  int workers = luaL_checkinteger(L, 2);
+  lovrAssert(workers >= 0, "Worker count can not be negative");
+  lovrWorldSetWorkerCount(world, workers);
+  return 0;
+}
+
 const luaL_Reg lovrWorld[] = {
   { "newCollider", l_lovrWorldNewCollider },
   { "newBoxCollider", l_lovrWorldNewBoxCollider },
@@ -346,11 +658,19 @@ const luaL_Reg lovrWorld[] = {
   { "newSphereCollider", l_lovrWorldNewSphereCollider },
   { "newMeshCollider", l_lovrWorldNewMeshCollider },
   { "getColliders", l_lovrWorldGetColliders },
+  { "getPoses", l_lovrWorldGetPoses },
   { "destroy", l_lovrWorldDestroy },
   { "update", l_lovrWorldUpdate },
   { "computeOverlaps", l_lovrWorldComputeOverlaps },
   { "overlaps", l_lovrWorldOverlaps },
   { "collide", l_lovrWorldCollide },
+  { "computeContacts", l_lovrWorldComputeContacts },
+  { "getContactCount", l_lovrWorldGetContactCount },
+  { "getContact", l_lovrWorldGetContact },
+  { "getContacts", l_lovrWorldGetContacts },
+  { "resolveContacts", l_lovrWorldResolveContacts },
+  { "snapshot", l_lovrWorldSnapshot },
+  { "restore", l_lovrWorldRestore },
   { "getGravity", l_lovrWorldGetGravity },
   { "setGravity", l_lovrWorldSetGravity },
   { "getTightness", l_lovrWorldGetTightness },
@@ -364,8 +684,21 @@ const luaL_Reg lovrWorld[] = {
   { "isSleepingAllowed", l_lovrWorldIsSleepingAllowed },
   { "setSleepingAllowed", l_lovrWorldSetSleepingAllowed },
   { "raycast", l_lovrWorldRaycast },
+  { "raycastMany", l_lovrWorldRaycastMany },
+  { "sweepMany", l_lovrWorldSweepMany },
   { "disableCollisionBetween", l_lovrWorldDisableCollisionBetween },
   { "enableCollisionBetween", l_lovrWorldEnableCollisionBetween },
   { "isCollisionEnabledBetween", l_lovrWorldIsCollisionEnabledBetween },
+  { "getMaterial", l_lovrWorldGetMaterial },
+  { "setMaterial", l_lovrWorldSetMaterial },
+  { "getPairCounts", l_lovrWorldGetPairCounts },
+  { "getCollisionTime", l_lovrWorldGetCollisionTime },
+  { "getTimestep", l_lovrWorldGetTimestep },
+  { "setTimestep", l_lovrWorldSetTimestep },
+  { "getIterations", l_lovrWorldGetIterations },
+  { "setIterations", l_lovrWorldSetIterations },
+  { "getInterpolation", l_lovrWorldGetInterpolation },
+  { "getWorkerCount", l_lovrWorldGetWorkerCount },
+  { "setWorkerCount", l_lovrWorldSetWorkerCount },
   { NULL, NULL }
 };
@@ -2,6 +2,7 @@
 #include "event/event.h"
 #include "thread/thread.h"
 #include "thread/channel.h"
+#include "core/os.h"
 #include "core/ref.h"
 #include <stdlib.h>
 #include <string.h>
@@ -88,15 +89,30 @@ static int l_lovrThreadNewThread(lua_State* L) {
 
 static int l_lovrThreadGetChannel(lua_State* L) {
   const char* name = luaL_checkstring(L, 1);
-  Channel* channel = lovrThreadGetChannel(name);
+  uint32_t capacity = luaL_optinteger(L, 2, 0);
+  Channel* channel = lovrThreadGetChannel(name, capacity);
   luax_pushtype(L, Channel, channel);
   // Note: Channels are intentionally not released here (see thread.h)
   return 1;
 }
 
+static int l_lovrThreadNewJob(lua_State* L) {
+  Job* job = lovrJobCreate();
+  luax_pushtype(L, Job, job);
+  lovrRelease(Job, job);
+  return 1;
+}
+
+static int l_lovrThreadGetWorkerCount(lua_State* L) {
+  lua_pushinteger(L, job_getWorkerCount());
+  return 1;
+}
+
 static const luaL_Reg lovrThreadModule[] = {
   { "newThread", l_lovrThreadNewThread },
   { "getChannel", l_lovrThreadGetChannel },
+  { "newJob", l_lovrThreadNewJob },
+  { "getWorkerCount", l_lovrThreadGetWorkerCount },
   { NULL, NULL }
 };
 
@@ -105,7 +121,27 @@ int luaopen_lovr_thread(lua_State* L) {
   luax_register(L, lovrThreadModule);
   luax_registertype(L, Thread);
   luax_registertype(L, Channel);
-  if (lovrThreadModuleInit()) {
+  luax_registertype(L, Job);
+
+  // A negative worker count leaves one core for the main thread
+  int workerCount = -1;
+  luax_pushconf(L);
+  if (lua_istable(L, -1)) {
+    lua_getfield(L, -1, "thread");
+    if (lua_istable(L, -1)) {
+      lua_getfield(L, -1, "workers");
+      workerCount = luaL_optinteger(L, -1, -1);
+      lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+  }
+  lua_pop(L, 1);
+
+  if (workerCount < 0) {
+    workerCount = (int) lovrPlatformGetCoreCount() - 1;
+  }
+
+  if (lovrThreadModuleInit(workerCount)) {
     luax_atexit(L, lovrThreadModuleDestroy);
   }
   return 1;
@@ -26,6 +26,15 @@ static int l_lovrChannelPush(lua_State* L) {
   luax_checktimeout(L, 3, &timeout);
   uint64_t id;
   bool read = lovrChannelPush(channel, &variant, timeout, &id);
+
+  // Channels with a capacity return a zero id when they're full and the message was dropped
+  if (id == 0) {
+    lovrVariantDestroy(&variant);
+    lua_pushnil(L);
+    lua_pushboolean(L, false);
+    return 2;
+  }
+
   lua_pushnumber(L, id);
   lua_pushboolean(L, read);
   return 2;
@@ -45,6 +54,39 @@ static int l_lovrChannelPop(lua_State* L) {
   return 1;
 }
 
+static int l_lovrChannelPopAll(lua_State* L) {
+  Channel* channel = luax_checktype(L, 1, Channel);
+
+  if (lua_istable(L, 2)) {
+    lua_settop(L, 2);
+  } else {
+    lua_settop(L, 1);
+    lua_newtable(L);
+  }
+
+  int count = 0;
+  size_t popped;
+  Variant variants[64];
+  do {
+    popped = lovrChannelPopMany(channel, variants, sizeof(variants) / sizeof(variants[0]));
+    for (size_t i = 0; i < popped; i++) {
+      luax_pushvariant(L, &variants[i]);
+      lovrVariantDestroy(&variants[i]);
+      lua_rawseti(L, 2, ++count);
+    }
+  } while (popped == sizeof(variants) / sizeof(variants[0]));
+
+  // Clear out anything left over in a reused table
+  int length = luax_len(L, 2);
+  for (int i = count + 1; i <= length; i++) {
+    lua_pushnil(L);
+    lua_rawseti(L, 2, i);
+  }
+
+  lua_pushinteger(L, count);
+  return 2;
+}
+
 static int l_lovrChannelPeek(lua_State* L) {
   Variant variant;
   Channel* channel = luax_checktype(L, 1, Channel);
@@ -70,6 +112,12 @@ static int l_lovrChannelGetCount(lua_State* L) {
   return 1;
 }
 
+static int l_lovrChannelGetCapacity(lua_State* L) {
+  Channel* channel = luax_checktype(L, 1, Channel);
+  lua_pushinteger(L, lovrChannelGetCapacity(channel));
+  return 1;
+}
+
 static int l_lovrChannelHasRead(lua_State* L) {
   Channel* channel = luax_checktype(L, 1, Channel);
   uint64_t id = luaL_checkinteger(L, 2);
@@ -80,9 +128,11 @@ static int l_lovrChannelHasRead(lua_State* L) {
 const luaL_Reg lovrChannel[] = {
   { "push", l_lovrChannelPush },
   { "pop", l_lovrChannelPop },
+  { "popAll", l_lovrChannelPopAll },
   { "peek", l_lovrChannelPeek },
   { "clear", l_lovrChannelClear },
   { "getCount", l_lovrChannelGetCount },
+  { "getCapacity", l_lovrChannelGetCapacity },
   { "hasRead", l_lovrChannelHasRead },
   { NULL, NULL }
 };
@@ -0,0 +1,20 @@
+#include "api.h"
+#include "thread/thread.h"
+
+static int l_lovrJobWait(lua_State* L) {
+  Job* job = luax_checktype(L, 1, Job);
+  lovrJobWait(job);
+  return 0;
+}
+
+static int l_lovrJobIsComplete(lua_State* L) {
+  Job* job = luax_checktype(L, 1, Job);
+  lua_pushboolean(L, lovrJobIsComplete(job));
+  return 1;
+}
+
+const luaL_Reg lovrJob[] = {
+  { "wait", l_lovrJobWait },
+  { "isComplete", l_lovrJobIsComplete },
+  { NULL, NULL }
+};
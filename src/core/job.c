@@ -0,0 +1,328 @@
+#include "core/job.h"
+#include "core/util.h"
+#include <stdlib.h>
+
+typedef struct JobGroup {
+  jobFn* fn;
+  void* context;
+  uint32_t count;
+  JobCounter* counter;
+  struct JobGroup* next;
+} JobGroup;
+
+static void runGroup(JobGroup* group);
+
+// Counters are only touched by the jobs themselves, so a counter is finished when it has no pending
+// jobs and no job is still releasing the jobs that depend on it.
+bool job_done(JobCounter* counter) {
+  return ref_get(&counter->pending) == 0 && ref_get(&counter->releasing) == 0;
+}
+
+#ifndef LOVR_ENABLE_THREAD
+
+// Without threads, jobs run immediately
+
+bool job_init(uint32_t workerCount) {
+  return true;
+}
+
+void job_destroy() {
+  //
+}
+
+uint32_t job_getWorkerCount() {
+  return 0;
+}
+
+void job_run(jobFn* fn, void* context, uint32_t count, JobCounter* counter, JobCounter* dependency) {
+  runGroup(&(JobGroup) { fn, context, count, counter, NULL });
+}
+
+void job_wait(JobCounter* counter) {
+  //
+}
+
+static void runGroup(JobGroup* group) {
+  for (uint32_t i = 0; i < group->count; i++) {
+    group->fn(group->context, i);
+  }
+}
+
+#else
+
+#include "lib/tinycthread/tinycthread.h"
+
+#define MAX_WORKERS 16
+#define QUEUE_SIZE 256
+#define WAIT_SPINS 64
+
+typedef struct {
+  jobFn* fn;
+  void* context;
+  uint32_t index;
+  JobCounter* counter;
+} Job;
+
+// The owner pushes and pops at the head, thieves take the oldest jobs from the tail
+typedef struct {
+  mtx_t lock;
+  uint32_t head;
+  uint32_t tail;
+  Job jobs[QUEUE_SIZE];
+} Queue;
+
+static struct {
+  bool initialized;
+  bool quit;
+  uint32_t queueCount;
+  Queue queues[MAX_WORKERS + 1];
+  thrd_t threads[MAX_WORKERS];
+  Ref queued;
+  Ref waiters;
+  Ref nextQueue;
+  mtx_t sleepLock;
+  cnd_t wake;
+  mtx_t dependencyLock;
+} state;
+
+// Queue 0 belongs to the thread that called job_init, other threads don't own a queue
+static LOVR_THREAD_LOCAL uint32_t currentQueue = ~0u;
+
+static bool push(Queue* queue, Job* job) {
+  mtx_lock(&queue->lock);
+  if (queue->head - queue->tail >= QUEUE_SIZE) {
+    mtx_unlock(&queue->lock);
+    return false;
+  }
+  queue->jobs[queue->head++ % QUEUE_SIZE] = *job;
+  mtx_unlock(&queue->lock);
+  ref_inc(&state.queued);
+  return true;
+}
+
+static bool pop(Queue* queue, Job* job, bool steal) {
+  mtx_lock(&queue->lock);
+  if (queue->head == queue->tail) {
+    mtx_unlock(&queue->lock);
+    return false;
+  }
+  *job = queue->jobs[(steal ? queue->tail++ : --queue->head) % QUEUE_SIZE];
+  mtx_unlock(&queue->lock);
+  ref_dec(&state.queued);
+  return true;
+}
+
+static bool findJob(Job* job) {
+  uint32_t self = currentQueue;
+
+  if (self != ~0u && pop(&state.queues[self], job, false)) {
+    return true;
+  }
+
+  uint32_t start = self == ~0u ? 0 : self + 1;
+  for (uint32_t i = 0; i < state.queueCount; i++) {
+    uint32_t victim = (start + i) % state.queueCount;
+    if (victim != self && pop(&state.queues[victim], job, true)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void runJob(Job* job) {
+  job->fn(job->context, job->index);
+
+  JobCounter* counter = job->counter;
+  if (!counter) {
+    return;
+  }
+
+  ref_inc(&counter->releasing);
+  if (ref_dec(&counter->pending) == 0 && state.initialized) {
+    mtx_lock(&state.dependencyLock);
+    JobGroup* group = counter->waiting;
+    counter->waiting = NULL;
+    mtx_unlock(&state.dependencyLock);
+
+    while (group) {
+      JobGroup* next = group->next;
+      runGroup(group);
+      free(group);
+      group = next;
+    }
+  }
+
+  // The counter might be gone once it's released, so any waiters are woken up to check their own
+  if (ref_dec(&counter->releasing) == 0 && ref_get(&state.waiters) > 0) {
+    mtx_lock(&state.sleepLock);
+    cnd_broadcast(&state.wake);
+    mtx_unlock(&state.sleepLock);
+  }
+}
+
+static void runGroup(JobGroup* group) {
+  if (!state.initialized) {
+    for (uint32_t i = 0; i < group->count; i++) {
+      runJob(&(Job) { group->fn, group->context, i, group->counter });
+    }
+    return;
+  }
+
+  uint32_t index = currentQueue;
+  if (index == ~0u) {
+    index = ref_inc(&state.nextQueue) % state.queueCount;
+  }
+
+  // If the queue is full, the job runs right away, which also keeps the queue from growing forever
+  for (uint32_t i = 0; i < group->count; i++) {
+    Job job = { group->fn, group->context, i, group->counter };
+    if (!push(&state.queues[index], &job)) {
+      runJob(&job);
+    }
+  }
+
+  mtx_lock(&state.sleepLock);
+  cnd_broadcast(&state.wake);
+  mtx_unlock(&state.sleepLock);
+}
+
+static int workerLoop(void* arg) {
+  currentQueue = (uint32_t) (uintptr_t) arg;
+
+  for (;;) {
+    Job job;
+    if (findJob(&job)) {
+      runJob(&job);
+      continue;
+    }
+
+    mtx_lock(&state.sleepLock);
+    while (!state.quit && ref_get(&state.queued) == 0) {
+      cnd_wait(&state.wake, &state.sleepLock);
+    }
+    bool quit = state.quit;
+    mtx_unlock(&state.sleepLock);
+
+    if (quit) {
+      return 0;
+    }
+  }
+}
+
+bool job_init(uint32_t workerCount) {
+  if (state.initialized) return false;
+  workerCount = MIN(workerCount, MAX_WORKERS);
+  state.queueCount = workerCount + 1;
+  state.quit = false;
+
+  for (uint32_t i = 0; i < state.queueCount; i++) {
+    mtx_init(&state.queues[i].lock, mtx_plain);
+  }
+
+  mtx_init(&state.sleepLock, mtx_plain);
+  mtx_init(&state.dependencyLock, mtx_plain);
+  cnd_init(&state.wake);
+  currentQueue = 0;
+  state.initialized = true;
+
+  for (uint32_t i = 0; i < workerCount; i++) {
+    if (thrd_create(&state.threads[i], workerLoop, (void*) (uintptr_t) (i + 1)) != thrd_success) {
+      lovrThrow("Could not create worker thread");
+    }
+  }
+
+  return true;
+}
+
+void job_destroy() {
+  if (!state.initialized) return;
+
+  // Finish everything that's still queued so nothing is left waiting on a counter
+  Job job;
+  while (findJob(&job)) {
+    runJob(&job);
+  }
+
+  mtx_lock(&state.sleepLock);
+  state.quit = true;
+  cnd_broadcast(&state.wake);
+  mtx_unlock(&state.sleepLock);
+
+  for (uint32_t i = 0; i < state.queueCount - 1; i++) {
+    thrd_join(state.threads[i], NULL);
+  }
+
+  for (uint32_t i = 0; i < state.queueCount; i++) {
+    mtx_destroy(&state.queues[i].lock);
+  }
+
+  mtx_destroy(&state.sleepLock);
+  mtx_destroy(&state.dependencyLock);
+  cnd_destroy(&state.wake);
+  currentQueue = ~0u;
+  state.initialized = false;
+}
+
+uint32_t job_getWorkerCount() {
+  return state.initialized ? state.queueCount - 1 : 0;
+}
+
+void job_run(jobFn* fn, void* context, uint32_t count, JobCounter* counter, JobCounter* dependency) {
+  if (count == 0) {
+    return;
+  }
+
+  if (counter) {
+    for (uint32_t i = 0; i < count; i++) {
+      ref_inc(&counter->pending);
+    }
+  }
+
+  JobGroup group = { fn, context, count, counter, NULL };
+
+  if (dependency && state.initialized) {
+    mtx_lock(&state.dependencyLock);
+    if (ref_get(&dependency->pending) > 0) {
+      JobGroup* waiting = malloc(sizeof(JobGroup));
+      lovrAssert(waiting, "Out of memory");
+      *waiting = group;
+      waiting->next = dependency->waiting;
+      dependency->waiting = waiting;
+      mtx_unlock(&state.dependencyLock);
+      return;
+    }
+    mtx_unlock(&state.dependencyLock);
+  } else if (dependency) {
+    job_wait(dependency);
+  }
+
+  runGroup(&group);
+}
+
+// Waiting threads help with queued jobs.  When there's nothing to steal but the counter is still
+// busy on other threads, they spin for a bit and then sleep until a counter is released or more
+// jobs are queued.
+void job_wait(JobCounter* counter) {
+  uint32_t spins = 0;
+  while (!job_done(counter)) {
+    Job job;
+    if (findJob(&job)) {
+      runJob(&job);
+      spins = 0;
+    } else if (spins++ < WAIT_SPINS || !state.initialized) {
+      thrd_yield();
+    } else {
+      ref_inc(&state.waiters);
+      mtx_lock(&state.sleepLock);
+      while (!job_done(counter) && ref_get(&state.queued) == 0) {
+        cnd_wait(&state.wake, &state.sleepLock);
+      }
+      mtx_unlock(&state.sleepLock);
+      ref_dec(&state.waiters);
+      spins = 0;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,30 @@
+#include "core/ref.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#pragma once
+
+// A small work stealing job scheduler.  Every worker thread (and the thread that initialized the
+// scheduler) has its own queue, and workers that run out of jobs steal from the other queues.
+// Each job is a function and an index, so a parallel loop is a single job_run call.  Counters keep
+// track of how many jobs of a group haven't finished yet.  A thread that waits on a counter runs
+// jobs itself until the counter reaches zero, and only sleeps when there's nothing left to run.
+// Jobs can also wait on another counter before they are queued, which is how dependencies are
+// expressed.
+// Jobs run on arbitrary threads, so they must not throw errors or use the graphics context.
+// If the scheduler isn't initialized, or threads are disabled, jobs run immediately.
+
+typedef void jobFn(void* context, uint32_t index);
+
+typedef struct JobCounter {
+  Ref pending;
+  Ref releasing;
+  struct JobGroup* waiting;
+} JobCounter;
+
+bool job_init(uint32_t workerCount);
+void job_destroy(void);
+uint32_t job_getWorkerCount(void);
+void job_run(jobFn* fn, void* context, uint32_t count, JobCounter* counter, JobCounter* dependency);
+bool job_done(JobCounter* counter);
+void job_wait(JobCounter* counter);
@@ -11,6 +11,38 @@
 #define MAF static LOVR_INLINE
 #endif
 
+// Matrix products use SSE or NEON when the target has it, define MAF_NO_SIMD to use scalar code.
+// Vectors don't need to be aligned, so unaligned loads and stores are used.
+#ifndef MAF_NO_SIMD
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MAF_SIMD
+typedef __m128 maf_f4;
+#define maf_load(p) _mm_loadu_ps(p)
+#define maf_store(p, v) _mm_storeu_ps(p, v)
+#define maf_splat(x) _mm_set1_ps(x)
+#define maf_add(a, b) _mm_add_ps(a, b)
+#define maf_mul(a, b) _mm_mul_ps(a, b)
+#define maf_madd(a, b, c) _mm_add_ps(_mm_mul_ps(a, b), c)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MAF_SIMD
+typedef float32x4_t maf_f4;
+#define maf_load(p) vld1q_f32(p)
+#define maf_store(p, v) vst1q_f32(p, v)
+#define maf_splat(x) vdupq_n_f32(x)
+#define maf_add(a, b) vaddq_f32(a, b)
+#define maf_mul(a, b) vmulq_f32(a, b)
+#define maf_madd(a, b, c) vmlaq_f32(c, a, b)
+#endif
+#endif
+
+#ifdef MAF_SIMD
+// Linear combination of the 4 columns of a matrix
+#define maf_combine(c, x, y, z, w)\
+  maf_madd(c[3], maf_splat(w), maf_madd(c[2], maf_splat(z), maf_madd(c[1], maf_splat(y), maf_mul(c[0], maf_splat(x)))))
+#endif
+
 typedef float* vec3;
 typedef float* quat;
 typedef float* mat4;
@@ -231,6 +263,15 @@ MAF quat quat_slerp(quat q, quat r, float t) {
   return q;
 }
 
+// Slerps count pairs of quaternions by the same amount, out can be the same array as q
+MAF void quat_slerpMany(float* out, const float* q, const float* r, float t, size_t count) {
+  for (size_t i = 0; i < count; i++, out += 4, q += 4, r += 4) {
+    float result[4] = { q[0], q[1], q[2], q[3] };
+    quat_slerp(result, (float*) r, t);
+    memcpy(out, result, sizeof(result));
+  }
+}
+
 MAF void quat_rotate(quat q, vec3 v) {
   float s = q[3];
   float u[4];
@@ -441,6 +482,18 @@ MAF mat4 mat4_invert(mat4 m) {
 
 // Calculate matrix equivalent to "apply n, then m"
 MAF mat4 mat4_multiply(mat4 m, mat4 n) {
+#ifdef MAF_SIMD
+  maf_f4 c[4] = { maf_load(m + 0), maf_load(m + 4), maf_load(m + 8), maf_load(m + 12) };
+  maf_f4 r0 = maf_combine(c, n[0], n[1], n[2], n[3]);
+  maf_f4 r1 = maf_combine(c, n[4], n[5], n[6], n[7]);
+  maf_f4 r2 = maf_combine(c, n[8], n[9], n[10], n[11]);
+  maf_f4 r3 = maf_combine(c, n[12], n[13], n[14], n[15]);
+  maf_store(m + 0, r0);
+  maf_store(m + 4, r1);
+  maf_store(m + 8, r2);
+  maf_store(m + 12, r3);
+  return m;
+#else
   float m00 = m[0], m01 = m[1], m02 = m[2], m03 = m[3],
         m10 = m[4], m11 = m[5], m12 = m[6], m13 = m[7],
         m20 = m[8], m21 = m[9], m22 = m[10], m23 = m[11],
@@ -468,9 +521,15 @@ MAF mat4 mat4_multiply(mat4 m, mat4 n) {
   m[14] = n30 * m02 + n31 * m12 + n32 * m22 + n33 * m32;
   m[15] = n30 * m03 + n31 * m13 + n32 * m23 + n33 * m33;
   return m;
+#endif
 }
 
 MAF float* mat4_multiplyVec4(mat4 m, float* v) {
+#ifdef MAF_SIMD
+  maf_f4 c[4] = { maf_load(m + 0), maf_load(m + 4), maf_load(m + 8), maf_load(m + 12) };
+  maf_store(v, maf_combine(c, v[0], v[1], v[2], v[3]));
+  return v;
+#else
   float x = v[0] * m[0] + v[1] * m[4] + v[2] * m[8] + v[3] * m[12];
   float y = v[0] * m[1] + v[1] * m[5] + v[2] * m[9] + v[3] * m[13];
   float z = v[0] * m[2] + v[1] * m[6] + v[2] * m[10] + v[3] * m[14];
@@ -480,6 +539,31 @@ MAF float* mat4_multiplyVec4(mat4 m, float* v) {
   v[2] = z;
   v[3] = w;
   return v;
+#endif
+}
+
+// Multiplies m with each of the count matrices in n, writing the results to out (which can be n)
+MAF void mat4_multiplyMany(float* out, mat4 m, const float* n, size_t count) {
+#ifdef MAF_SIMD
+  maf_f4 c[4] = { maf_load(m + 0), maf_load(m + 4), maf_load(m + 8), maf_load(m + 12) };
+  for (size_t i = 0; i < count; i++, n += 16, out += 16) {
+    maf_f4 r0 = maf_combine(c, n[0], n[1], n[2], n[3]);
+    maf_f4 r1 = maf_combine(c, n[4], n[5], n[6], n[7]);
+    maf_f4 r2 = maf_combine(c, n[8], n[9], n[10], n[11]);
+    maf_f4 r3 = maf_combine(c, n[12], n[13], n[14], n[15]);
+    maf_store(out + 0, r0);
+    maf_store(out + 4, r1);
+    maf_store(out + 8, r2);
+    maf_store(out + 12, r3);
+  }
+#else
+  for (size_t i = 0; i < count; i++, n += 16, out += 16) {
+    float product[16];
+    memcpy(product, m, sizeof(product));
+    mat4_multiply(product, (float*) n);
+    memcpy(out, product, sizeof(product));
+  }
+#endif
 }
 
 MAF mat4 mat4_translate(mat4 m, float x, float y, float z) {
@@ -653,6 +737,15 @@ MAF mat4 mat4_lookAt(mat4 m, vec3 from, vec3 to, vec3 up) {
 // Apply matrix to a vec3
 // Difference from mat4_multiplyVec4: w normalize is performed, w in vec3 is ignored
 MAF void mat4_transform(mat4 m, vec3 v) {
+#ifdef MAF_SIMD
+  maf_f4 c[4] = { maf_load(m + 0), maf_load(m + 4), maf_load(m + 8), maf_load(m + 12) };
+  maf_store(v, maf_combine(c, v[0], v[1], v[2], 1.f));
+  float w = v[3];
+  v[0] /= w;
+  v[1] /= w;
+  v[2] /= w;
+  v[3] = 1.f;
+#else
   float x = v[0] * m[0] + v[1] * m[4] + v[2] * m[8] + m[12];
   float y = v[0] * m[1] + v[1] * m[5] + v[2] * m[9] + m[13];
   float z = v[0] * m[2] + v[1] * m[6] + v[2] * m[10] + m[14];
@@ -661,6 +754,29 @@ MAF void mat4_transform(mat4 m, vec3 v) {
   v[1] = y / w;
   v[2] = z / w;
   v[3] = w / w;
+#endif
+}
+
+// Transforms count points that are stride floats apart, only the xyz of each point is written
+MAF void mat4_transformPoints(mat4 m, float* points, size_t count, size_t stride) {
+#ifdef MAF_SIMD
+  maf_f4 c[4] = { maf_load(m + 0), maf_load(m + 4), maf_load(m + 8), maf_load(m + 12) };
+  float result[4];
+  for (size_t i = 0; i < count; i++, points += stride) {
+    maf_store(result, maf_combine(c, points[0], points[1], points[2], 1.f));
+    points[0] = result[0] / result[3];
+    points[1] = result[1] / result[3];
+    points[2] = result[2] / result[3];
+  }
+#else
+  for (size_t i = 0; i < count; i++, points += stride) {
+    float v[4] = { points[0], points[1], points[2], 1.f };
+    mat4_transform(m, v);
+    points[0] = v[0];
+    points[1] = v[1];
+    points[2] = v[2];
+  }
+#endif
 }
 
 MAF void mat4_transformDirection(mat4 m, vec3 v) {
@@ -142,6 +142,7 @@ const char* lovrPlatformGetName(void);
 double lovrPlatformGetTime(void);
 void lovrPlatformSetTime(double t);
 void lovrPlatformSleep(double seconds);
+uint32_t lovrPlatformGetCoreCount(void);
 void lovrPlatformOpenConsole(void);
 void lovrPlatformPollEvents(void);
 size_t lovrPlatformGetHomeDirectory(char* buffer, size_t size);
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include <pthread.h>
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
@@ -212,6 +213,11 @@ void lovrPlatformSleep(double seconds) {
   while (nanosleep(&t, &t));
 }
 
+uint32_t lovrPlatformGetCoreCount() {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (uint32_t) count : 1;
+}
+
 void lovrPlatformPollEvents() {
   // Notes about polling:
   // - Stop polling if a destroy is requested to give the application a chance to shut down.
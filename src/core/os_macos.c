@@ -49,6 +49,11 @@ void lovrPlatformSleep(double seconds) {
   while (nanosleep(&t, &t));
 }
 
+uint32_t lovrPlatformGetCoreCount() {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (uint32_t) count : 1;
+}
+
 void lovrPlatformOpenConsole() {
   //
 }
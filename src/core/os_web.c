@@ -223,6 +223,10 @@ void lovrPlatformSleep(double seconds) {
   emscripten_sleep((unsigned int) (seconds * 1000. + .5));
 }
 
+uint32_t lovrPlatformGetCoreCount() {
+  return 1;
+}
+
 void lovrPlatformOpenConsole() {
   //
 }
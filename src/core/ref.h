@@ -1,3 +1,4 @@
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -14,6 +15,9 @@
 typedef uint32_t Ref;
 static inline uint32_t ref_inc(Ref* ref) { return ++*ref; }
 static inline uint32_t ref_dec(Ref* ref) { return --*ref; }
+static inline uint32_t ref_get(Ref* ref) { return *ref; }
+static inline void ref_set(Ref* ref, uint32_t value) { *ref = value; }
+static inline bool ref_cas(Ref* ref, uint32_t expected, uint32_t value) { return *ref == expected ? (*ref = value, true) : false; }
 
 #elif defined(_MSC_VER)
 
@@ -23,6 +27,9 @@ static inline uint32_t ref_dec(Ref* ref) { return --*ref; }
 typedef uint32_t Ref;
 static inline uint32_t ref_inc(Ref* ref) { return _InterlockedIncrement((volatile long*) ref); }
 static inline uint32_t ref_dec(Ref* ref) { return _InterlockedDecrement((volatile long*) ref); }
+static inline uint32_t ref_get(Ref* ref) { return _InterlockedOr((volatile long*) ref, 0); }
+static inline void ref_set(Ref* ref, uint32_t value) { _InterlockedExchange((volatile long*) ref, value); }
+static inline bool ref_cas(Ref* ref, uint32_t expected, uint32_t value) { return (uint32_t) _InterlockedCompareExchange((volatile long*) ref, value, expected) == expected; }
 
 #elif (defined(__GNUC_MINOR__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))) \
    || (__has_builtin(__atomic_add_fetch) && __has_builtin(__atomic_sub_fetch))
@@ -32,6 +39,9 @@ static inline uint32_t ref_dec(Ref* ref) { return _InterlockedDecrement((volatil
 typedef uint32_t Ref;
 static inline uint32_t ref_inc(Ref* ref) { return __atomic_add_fetch(ref, 1, __ATOMIC_SEQ_CST); }
 static inline uint32_t ref_dec(Ref* ref) { return __atomic_sub_fetch(ref, 1, __ATOMIC_SEQ_CST); }
+static inline uint32_t ref_get(Ref* ref) { return __atomic_load_n(ref, __ATOMIC_SEQ_CST); }
+static inline void ref_set(Ref* ref, uint32_t value) { __atomic_store_n(ref, value, __ATOMIC_SEQ_CST); }
+static inline bool ref_cas(Ref* ref, uint32_t expected, uint32_t value) { return __atomic_compare_exchange_n(ref, &expected, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); }
 
 #else
 
@@ -46,6 +56,9 @@ static inline uint32_t ref_dec(Ref* ref) { return __atomic_sub_fetch(ref, 1, __A
 typedef _Atomic(uint32_t) Ref;
 static inline uint32_t ref_inc(Ref* ref) { return atomic_fetch_add(ref, 1) + 1; }
 static inline uint32_t ref_dec(Ref* ref) { return atomic_fetch_sub(ref, 1) - 1; }
+static inline uint32_t ref_get(Ref* ref) { return atomic_load(ref); }
+static inline void ref_set(Ref* ref, uint32_t value) { atomic_store(ref, value); }
+static inline bool ref_cas(Ref* ref, uint32_t expected, uint32_t value) { return atomic_compare_exchange_strong(ref, &expected, value); }
 
 #endif
 
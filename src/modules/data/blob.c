@@ -1,4 +1,6 @@
 #include "data/blob.h"
+#include "core/ref.h"
+#include "core/util.h"
 #include <stdlib.h>
 
 Blob* lovrBlobInit(Blob* blob, void* data, size_t size, const char* name) {
@@ -10,5 +12,35 @@ Blob* lovrBlobInit(Blob* blob, void* data, size_t size, const char* name) {
 
 void lovrBlobDestroy(void* ref) {
   Blob* blob = ref;
-  free(blob->data);
+  if (blob->parent) {
+    ref_dec(&blob->parent->views);
+    lovrRelease(Blob, blob->parent);
+  } else {
+    free(blob->data);
+  }
+}
+
+// Views of views point at the Blob that actually owns the data
+Blob* lovrBlobCreateView(Blob* parent, size_t offset, size_t size) {
+  lovrAssert(offset <= parent->size && size <= parent->size - offset, "Blob view (offset %zu, size %zu) is out of range (Blob size is %zu)", offset, size, parent->size);
+  Blob* view = lovrAlloc(Blob);
+  view->data = (char*) parent->data + offset;
+  view->size = size;
+  view->name = parent->name;
+  view->parent = parent->parent ? parent->parent : parent;
+  ref_inc(&view->parent->views);
+  lovrRetain(view->parent);
+  return view;
+}
+
+// The old Blob is left empty, so it has to be the only reference to the data: it can't be a view,
+// have views, or be retained by anything else.
+Blob* lovrBlobMove(Blob* blob) {
+  lovrAssert(!blob->parent, "Blob views can not be moved");
+  lovrAssert(ref_get(&blob->views) == 0, "Can not move a Blob that has views");
+  lovrAssert(ref_get(toRef(blob)) == 1, "Can not move a Blob that is in use by other objects");
+  Blob* moved = lovrBlobCreate(blob->data, blob->size, blob->name);
+  blob->data = NULL;
+  blob->size = 0;
+  return moved;
 }
@@ -1,13 +1,22 @@
+#include "core/ref.h"
 #include <stddef.h>
 
 #pragma once
 
+// A Blob can also be a read-only view of part of another Blob.  Views keep their parent alive and
+// never own their data.  Moving a Blob hands its data to a new Blob without copying it, which is
+// how big payloads are passed to other threads.
+
 typedef struct Blob {
   void* data;
   size_t size;
   const char* name;
+  struct Blob* parent;
+  Ref views;
 } Blob;
 
 Blob* lovrBlobInit(Blob* blob, void* data, size_t size, const char* name);
 #define lovrBlobCreate(...) lovrBlobInit(lovrAlloc(Blob), __VA_ARGS__)
 void lovrBlobDestroy(void* ref);
+Blob* lovrBlobCreateView(Blob* parent, size_t offset, size_t size);
+Blob* lovrBlobMove(Blob* blob);
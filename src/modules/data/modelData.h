@@ -6,7 +6,7 @@
 
 #pragma once
 
-#define MAX_BONES 48
+#define MAX_BONES 256
 
 struct TextureData;
 struct Blob;
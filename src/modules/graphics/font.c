@@ -98,7 +98,7 @@ Texture* lovrFontGetTexture(Font* font) {
   return font->texture;
 }
 
-void lovrFontRender(Font* font, const char* str, size_t length, float wrap, HorizontalAlign halign, float* vertices, uint16_t* indices, uint16_t baseVertex) {
+void lovrFontRender(Font* font, const char* str, size_t length, float wrap, HorizontalAlign halign, float* vertices, uint32_t* indices, uint32_t baseVertex) {
   FontAtlas* atlas = &font->atlas;
   bool flip = font->flip;
 
@@ -115,9 +115,9 @@ void lovrFontRender(Font* font, const char* str, size_t length, float wrap, Hori
   size_t bytes;
 
   float* vertexCursor = vertices;
-  uint16_t* indexCursor = indices;
+  uint32_t* indexCursor = indices;
   float* lineStart = vertices;
-  uint16_t I = baseVertex;
+  uint32_t I = baseVertex;
 
   while ((bytes = utf8_decode(str, end, &codepoint)) > 0) {
 
@@ -170,7 +170,7 @@ void lovrFontRender(Font* font, const char* str, size_t length, float wrap, Hori
         x2, y2, 0.f, 0.f, 0.f, 0.f, s2, t2
       }, 32 * sizeof(float));
 
-      memcpy(indexCursor, (uint16_t[6]) { I + 0, I + 1, I + 2, I + 2, I + 1, I + 3 }, 6 * sizeof(uint16_t));
+      memcpy(indexCursor, (uint32_t[6]) { I + 0, I + 1, I + 2, I + 2, I + 1, I + 3 }, 6 * sizeof(uint32_t));
 
       vertexCursor += 32;
       indexCursor += 6;
@@ -8,7 +8,9 @@
 #include "data/rasterizer.h"
 #include "event/event.h"
 #include "math/math.h"
+#include "core/arr.h"
 #include "core/maf.h"
+#include "core/map.h"
 #include "core/ref.h"
 #include "core/util.h"
 #include <stdlib.h>
@@ -18,6 +20,7 @@
 #define MAX_TRANSFORMS 64
 #define MAX_BATCHES 4
 #define MAX_DRAWS 256
+#define MAX_LOCKS 4
 
 typedef enum {
   STREAM_VERTEX,
@@ -26,6 +29,7 @@ typedef enum {
   STREAM_MODEL,
   STREAM_COLOR,
   STREAM_FRAME,
+  STREAM_POSE,
   MAX_STREAMS
 } StreamType;
 
@@ -52,7 +56,7 @@ typedef union {
   struct { float r1; float r2; bool capped; int segments; } cylinder;
   struct { int segments; } sphere;
   struct { float u; float v; float w; float h; } fill;
-  struct { uint32_t rangeStart; uint32_t rangeCount; uint32_t instances; float* pose; } mesh;
+  struct { uint32_t rangeStart; uint32_t rangeCount; uint32_t instances; float* pose; uint32_t poseCount; uint32_t poseVersion; } mesh;
 } BatchParams;
 
 typedef struct {
@@ -68,8 +72,8 @@ typedef struct {
   uint32_t vertexCount;
   uint32_t indexCount;
   float** vertices;
-  uint16_t** indices;
-  uint16_t* baseVertex;
+  uint32_t** indices;
+  uint32_t* baseVertex;
   bool instanced;
 } BatchRequest;
 
@@ -82,9 +86,33 @@ typedef struct {
   Color* colors;
   uint32_t drawStart;
   uint32_t drawCount;
+  uint32_t poseStart;
   bool indexed;
 } Batch;
 
+typedef struct {
+  Mesh* mesh;
+  Canvas* canvas;
+  Shader* shader;
+  Pipeline pipeline;
+  Material* material;
+  float transform[16];
+  Color color;
+} BatchContext;
+
+typedef struct {
+  BatchRequest request;
+  BatchContext context;
+  uint32_t vertexStart;
+  uint32_t indexStart;
+  uint32_t poseStart;
+} QueuedDraw;
+
+typedef struct {
+  uint64_t key;
+  uint32_t index;
+} SortKey;
+
 typedef struct {
   float viewMatrix[2][16];
   float projection[2][16];
@@ -117,34 +145,57 @@ static struct {
   Mesh* mesh;
   Mesh* instancedMesh;
   Buffer* identityBuffer;
+  Buffer* identityPose;
   Buffer* buffers[MAX_STREAMS];
+  uint32_t bufferCount[MAX_STREAMS];
+  size_t bufferStride[MAX_STREAMS];
+  uint32_t* indexStaging;
   uint32_t head[MAX_STREAMS];
   uint32_t tail[MAX_STREAMS];
+  void* locks[MAX_STREAMS][MAX_LOCKS];
+  uint32_t locked[MAX_STREAMS];
+  uint32_t poseAlign;
+  map_t poses;
+  uint64_t streamPeak;
+  GpuStats stats;
   Batch batches[MAX_BATCHES];
   uint8_t batchCount;
+  uint32_t culledCount;
+  bool sorting;
+  bool replaying;
+  arr_t(QueuedDraw) queue;
+  arr_t(SortKey) sortKeys;
+  arr_t(float) queueVertices;
+  arr_t(uint32_t) queueIndices;
+  arr_t(float) queuePoses;
+  map_t queuePalettes;
+  map_t queueGeometry;
 } state;
 
-static const uint32_t bufferCount[] = {
+static const uint32_t defaultBufferCount[] = {
   [STREAM_VERTEX] = (1 << 16) - 1,
   [STREAM_DRAWID] = (1 << 16) - 1,
   [STREAM_INDEX] = 1 << 16,
 #if defined(LOVR_WEBGL) // Work around bugs where big UBOs don't work
   [STREAM_MODEL] = MAX_DRAWS,
   [STREAM_COLOR] = MAX_DRAWS,
+  [STREAM_POSE] = MAX_BONES * MAX_BATCHES,
 #else
   [STREAM_MODEL] = MAX_DRAWS * MAX_BATCHES,
   [STREAM_COLOR] = MAX_DRAWS * MAX_BATCHES,
+  [STREAM_POSE] = MAX_BONES * MAX_BATCHES * 4,
 #endif
   [STREAM_FRAME] = 4
 };
 
-static const size_t bufferStride[] = {
+static const size_t defaultBufferStride[] = {
   [STREAM_VERTEX] = 8 * sizeof(float),
   [STREAM_DRAWID] = sizeof(uint8_t),
   [STREAM_INDEX] = sizeof(uint16_t),
   [STREAM_MODEL] = 16 * sizeof(float),
   [STREAM_COLOR] = 4 * sizeof(float),
-  [STREAM_FRAME] = sizeof(FrameData)
+  [STREAM_FRAME] = sizeof(FrameData),
+  [STREAM_POSE] = 16 * sizeof(float)
 };
 
 static const BufferType bufferType[] = {
@@ -153,7 +204,8 @@ static const BufferType bufferType[] = {
   [STREAM_INDEX] = BUFFER_INDEX,
   [STREAM_MODEL] = BUFFER_UNIFORM,
   [STREAM_COLOR] = BUFFER_UNIFORM,
-  [STREAM_FRAME] = BUFFER_UNIFORM
+  [STREAM_FRAME] = BUFFER_UNIFORM,
+  [STREAM_POSE] = BUFFER_UNIFORM
 };
 
 static void gammaCorrect(Color* color) {
@@ -174,23 +226,104 @@ static void onResizeWindow(int width, int height) {
   lovrEventPush((Event) { .type = EVENT_RESIZE, .data.resize = { width, height } });
 }
 
+// Each stream is a ring split into MAX_LOCKS ranges.  Once the head moves past a range and the
+// draws using it are submitted, a fence is placed after them.  Writing to a range waits on its
+// fence, so the CPU only stalls when it laps the GPU.
+static uint32_t lockSize(StreamType type) {
+  return (state.bufferCount[type] + MAX_LOCKS - 1) / MAX_LOCKS;
+}
+
+// Bytes of a stream the CPU can't write to yet: ranges still fenced plus writes not yet fenced
+static uint64_t lovrGraphicsGetStreamUsage(StreamType type) {
+  uint32_t size = lockSize(type);
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < MAX_LOCKS; i++) {
+    if (state.locks[type][i] && i * size < state.bufferCount[type]) {
+      uint32_t remaining = state.bufferCount[type] - i * size;
+      count += MIN(size, remaining);
+    }
+  }
+
+  uint32_t fenced = state.locked[type] * size;
+  count += state.head[type] > fenced ? state.head[type] - fenced : 0;
+  return (uint64_t) count * state.bufferStride[type];
+}
+
+// A palette in a range that is already fenced has to be written again for new draws, since the
+// fence was placed before them and wouldn't keep the range from being overwritten.
+static bool isPoseFenced(uint32_t poseStart) {
+  return poseStart < state.locked[STREAM_POSE] * lockSize(STREAM_POSE);
+}
+
+static void lovrGraphicsLockBuffer(StreamType type, uint32_t end) {
+  for (uint32_t i = state.locked[type]; i < end; i++) {
+    lovrGpuDestroyFence(state.locks[type][i]);
+    state.locks[type][i] = lovrGpuFence();
+  }
+
+  state.locked[type] = MAX(state.locked[type], end);
+}
+
 static void* lovrGraphicsMapBuffer(StreamType type, uint32_t count) {
-  lovrAssert(count <= bufferCount[type], "Whoa there!  Tried to get %d elements from a buffer that only has %d elements.", count, bufferCount[type]);
+  lovrAssert(count <= state.bufferCount[type], "Whoa there!  Tried to get %d elements from a buffer that only has %d elements.", count, state.bufferCount[type]);
 
-  if (state.head[type] + count > bufferCount[type]) {
+  if (state.head[type] + count > state.bufferCount[type]) {
     lovrAssert(state.batchCount == 0, "Internal error: Batches still exist during Buffer reset");
-    lovrBufferDiscard(state.buffers[type]);
+    lovrGraphicsLockBuffer(type, (state.head[type] + lockSize(type) - 1) / lockSize(type));
+    state.locked[type] = 0;
     state.tail[type] = 0;
     state.head[type] = 0;
+
+    // Palettes behind the head are about to be overwritten, so they can't be reused anymore
+    if (type == STREAM_POSE) {
+      map_free(&state.poses);
+      map_init(&state.poses, 0);
+    }
+  }
+
+  uint32_t first = state.head[type] / lockSize(type);
+  uint32_t last = (state.head[type] + count - 1) / lockSize(type);
+  for (uint32_t i = first; count > 0 && i <= last; i++) {
+    if (state.locks[type][i]) {
+      lovrGpuWait(state.locks[type][i], true);
+      lovrGpuDestroyFence(state.locks[type][i]);
+      state.locks[type][i] = NULL;
+    }
   }
 
-  return lovrBufferMap(state.buffers[type], state.head[type] * bufferStride[type], true);
+  uint64_t usage = (uint64_t) count * state.bufferStride[type];
+  for (int i = 0; i < MAX_STREAMS; i++) {
+    usage += lovrGraphicsGetStreamUsage(i);
+  }
+  state.streamPeak = MAX(state.streamPeak, usage);
+
+  // Primitives always write 32 bit indices.  With 16 bit indices they're narrowed during the flush.
+  if (type == STREAM_INDEX && state.bufferStride[STREAM_INDEX] == sizeof(uint16_t)) {
+    return state.indexStaging + state.head[type];
+  }
+
+  return lovrBufferMap(state.buffers[type], state.head[type] * state.bufferStride[type], true);
 }
 
 // Base
 
-bool lovrGraphicsInit(bool debug) {
+bool lovrGraphicsInit(bool debug, uint32_t vertexCount, uint32_t indexCount) {
   state.debug = debug;
+  memcpy(state.bufferCount, defaultBufferCount, sizeof(state.bufferCount));
+  memcpy(state.bufferStride, defaultBufferStride, sizeof(state.bufferStride));
+
+  // 16 bit indices can only address 65535 vertices (0xffff is the primitive restart index), so
+  // bigger vertex streams switch the index stream to 32 bit indices.
+  if (vertexCount > 0) {
+    state.bufferCount[STREAM_VERTEX] = vertexCount;
+    state.bufferCount[STREAM_DRAWID] = vertexCount;
+    state.bufferStride[STREAM_INDEX] = vertexCount > 0xffff ? sizeof(uint32_t) : sizeof(uint16_t);
+  }
+
+  if (indexCount > 0) {
+    state.bufferCount[STREAM_INDEX] = indexCount;
+  }
+
   return false; // See lovrGraphicsCreateWindow for actual initialization
 }
 
@@ -205,13 +338,26 @@ void lovrGraphicsDestroy() {
   }
   for (int i = 0; i < MAX_STREAMS; i++) {
     lovrRelease(Buffer, state.buffers[i]);
+    for (int j = 0; j < MAX_LOCKS; j++) {
+      lovrGpuDestroyFence(state.locks[i][j]);
+    }
   }
   lovrRelease(Mesh, state.mesh);
   lovrRelease(Mesh, state.instancedMesh);
   lovrRelease(Buffer, state.identityBuffer);
+  lovrRelease(Buffer, state.identityPose);
+  free(state.indexStaging);
   lovrRelease(Material, state.defaultMaterial);
   lovrRelease(Font, state.defaultFont);
   lovrRelease(Canvas, state.defaultCanvas);
+  arr_free(&state.queue);
+  arr_free(&state.sortKeys);
+  arr_free(&state.queueVertices);
+  arr_free(&state.queueIndices);
+  arr_free(&state.queuePoses);
+  map_free(&state.queuePalettes);
+  map_free(&state.queueGeometry);
+  map_free(&state.poses);
   lovrGpuDestroy();
   memset(&state, 0, sizeof(state));
 }
@@ -220,6 +366,19 @@ void lovrGraphicsPresent() {
   lovrGraphicsFlush();
   lovrPlatformSwapBuffers();
   lovrGpuPresent();
+  state.culledCount = 0;
+  map_free(&state.poses);
+  map_init(&state.poses, 0);
+
+  // Release fences the GPU has already passed, so the fence count reflects what's still in flight
+  for (int i = 0; i < MAX_STREAMS; i++) {
+    for (int j = 0; j < MAX_LOCKS; j++) {
+      if (state.locks[i][j] && lovrGpuWait(state.locks[i][j], false)) {
+        lovrGpuDestroyFence(state.locks[i][j]);
+        state.locks[i][j] = NULL;
+      }
+    }
+  }
 }
 
 void lovrGraphicsCreateWindow(WindowFlags* flags) {
@@ -235,8 +394,20 @@ void lovrGraphicsCreateWindow(WindowFlags* flags) {
   state.defaultCanvas = lovrCanvasCreateFromHandle(state.width, state.height, (CanvasFlags) { .stereo = false }, 0, 0, 0, 1, true);
   state.backbuffer = state.defaultCanvas;
 
+  // Palettes are packed tightly but the bound range always covers a whole pose block, so the pose
+  // stream has a block of padding past its end for palettes written near the end of the ring.
   for (int i = 0; i < MAX_STREAMS; i++) {
-    state.buffers[i] = lovrBufferCreate(bufferCount[i] * bufferStride[i], NULL, bufferType[i], USAGE_STREAM, false);
+    uint32_t padding = i == STREAM_POSE ? MAX_BONES : 0;
+    state.buffers[i] = lovrBufferCreatePersistent((state.bufferCount[i] + padding) * state.bufferStride[i], bufferType[i]);
+  }
+
+  uint32_t blockAlign = (uint32_t) lovrGpuGetLimits()->blockAlign;
+  state.poseAlign = MAX(blockAlign / (uint32_t) state.bufferStride[STREAM_POSE], 1);
+  map_init(&state.poses, 0);
+
+  if (state.bufferStride[STREAM_INDEX] == sizeof(uint16_t)) {
+    state.indexStaging = malloc(state.bufferCount[STREAM_INDEX] * sizeof(uint32_t));
+    lovrAssert(state.indexStaging, "Out of memory");
   }
 
   // The identity buffer is used for autoinstanced meshes and instanced primitives and maps the
@@ -247,8 +418,17 @@ void lovrGraphicsCreateWindow(WindowFlags* flags) {
   lovrBufferFlush(state.identityBuffer, 0, MAX_DRAWS);
   lovrBufferUnmap(state.identityBuffer);
 
+  // Unskinned draws still need something bound to the pose block, and the bound range has to cover
+  // the whole block, so a static palette of identity matrices is used for them.
+  size_t poseSize = MAX_BONES * 16 * sizeof(float);
+  state.identityPose = lovrBufferCreate(poseSize, NULL, BUFFER_UNIFORM, USAGE_STATIC, false);
+  float* bones = lovrBufferMap(state.identityPose, 0, true);
+  for (int i = 0; i < MAX_BONES; i++) mat4_identity(bones + 16 * i);
+  lovrBufferFlush(state.identityPose, 0, poseSize);
+  lovrBufferUnmap(state.identityPose);
+
   Buffer* vertexBuffer = state.buffers[STREAM_VERTEX];
-  size_t stride = bufferStride[STREAM_VERTEX];
+  size_t stride = state.bufferStride[STREAM_VERTEX];
 
   MeshAttribute position = { .buffer = vertexBuffer, .offset = 0, .stride = stride, .type = F32, .components = 3 };
   MeshAttribute normal = { .buffer = vertexBuffer, .offset = 12, .stride = stride, .type = F32, .components = 3 };
@@ -268,6 +448,14 @@ void lovrGraphicsCreateWindow(WindowFlags* flags) {
   lovrMeshAttachAttribute(state.instancedMesh, "lovrTexCoord", &texCoord);
   lovrMeshAttachAttribute(state.instancedMesh, "lovrDrawID", &identity);
 
+  arr_init(&state.queue);
+  arr_init(&state.sortKeys);
+  arr_init(&state.queueVertices);
+  arr_init(&state.queueIndices);
+  arr_init(&state.queuePoses);
+  map_init(&state.queuePalettes, 0);
+  map_init(&state.queueGeometry, 0);
+
   lovrGraphicsReset();
   state.initialized = true;
 }
@@ -343,6 +531,20 @@ void lovrGraphicsSetProjection(uint32_t index, float* projection) {
   state.frameDataDirty = true;
 }
 
+const GpuStats* lovrGraphicsGetStats() {
+  state.stats = *lovrGpuGetStats();
+  state.stats.streamMemory = 0;
+  for (int i = 0; i < MAX_STREAMS; i++) {
+    state.stats.streamMemory += lovrGraphicsGetStreamUsage(i);
+  }
+  state.stats.streamPeak = state.streamPeak;
+  return &state.stats;
+}
+
+uint32_t lovrGraphicsGetCulledCount() {
+  return state.culledCount;
+}
+
 Buffer* lovrGraphicsGetIdentityBuffer() {
   return state.identityBuffer;
 }
@@ -368,6 +570,7 @@ void lovrGraphicsReset() {
   lovrGraphicsSetLineWidth(1.f);
   lovrGraphicsSetPointSize(1.f);
   lovrGraphicsSetShader(NULL);
+  lovrGraphicsSetSortingEnabled(false);
   lovrGraphicsSetStencilTest(COMPARE_NONE, 0);
   lovrGraphicsSetWinding(WINDING_COUNTERCLOCKWISE);
   lovrGraphicsSetWireframe(false);
@@ -510,6 +713,17 @@ void lovrGraphicsSetShader(Shader* shader) {
   state.shader = shader;
 }
 
+bool lovrGraphicsIsSortingEnabled() {
+  return state.sorting;
+}
+
+void lovrGraphicsSetSortingEnabled(bool sorting) {
+  if (state.sorting != sorting) {
+    lovrGraphicsFlush();
+    state.sorting = sorting;
+  }
+}
+
 void lovrGraphicsGetStencilTest(CompareMode* mode, int* value) {
   *mode = state.pipeline.stencilMode;
   *value = state.pipeline.stencilValue;
@@ -571,15 +785,12 @@ void lovrGraphicsMatrixTransform(mat4 transform) {
 
 // Rendering
 
-static void lovrGraphicsBatch(BatchRequest* req) {
-
-  // Resolve objects
-  Mesh* mesh = req->mesh ? req->mesh : (req->instanced ? state.instancedMesh : state.mesh);
-  Canvas* canvas = state.canvas ? state.canvas : state.backbuffer;
-  bool stereo = lovrCanvasIsStereo(canvas);
-  Shader* shader = state.shader ? state.shader : (state.defaultShaders[req->shader][stereo] ? state.defaultShaders[req->shader][stereo] : (state.defaultShaders[req->shader][stereo] = lovrShaderCreateDefault(req->shader, NULL, 0, stereo)));
-  Pipeline* pipeline = req->pipeline ? req->pipeline : &state.pipeline;
-  Material* material = req->material ? req->material : (state.defaultMaterial ? state.defaultMaterial : (state.defaultMaterial = lovrMaterialCreate()));
+static void lovrGraphicsSubmit(BatchRequest* req, BatchContext* ctx) {
+  Mesh* mesh = ctx->mesh;
+  Canvas* canvas = ctx->canvas;
+  Shader* shader = ctx->shader;
+  Pipeline* pipeline = &ctx->pipeline;
+  Material* material = ctx->material;
 
   if (!req->material) {
     if (req->type == BATCH_SKYBOX && lovrTextureGetType(req->texture) == TEXTURE_CUBE) {
@@ -589,11 +800,16 @@ static void lovrGraphicsBatch(BatchRequest* req) {
     }
   }
 
-  if (lovrShaderHasUniform(shader, "lovrPose")) {
-    if (req->type == BATCH_MESH && req->params.mesh.pose) {
-      lovrShaderSetMatrices(shader, "lovrPose", req->params.mesh.pose, 0, MAX_BONES * 16);
-    } else {
-      lovrShaderSetMatrices(shader, "lovrPose", (float[]) MAT4_IDENTITY, 0, 16);
+  // Skin palettes are written to the pose stream once per frame, and every draw of the same palette
+  // version reuses its range, so they can share a batch.
+  uint32_t poseStart = ~0u;
+  uint64_t poseHash = 0;
+  bool skinned = req->type == BATCH_MESH && req->params.mesh.pose;
+  if (skinned && req->params.mesh.poseVersion) {
+    poseHash = hash64(&req->params.mesh.poseVersion, sizeof(uint32_t));
+    uint64_t cached = map_get(&state.poses, poseHash);
+    if (cached != MAP_NIL && !isPoseFenced((uint32_t) cached)) {
+      poseStart = (uint32_t) cached;
     }
   }
 
@@ -601,10 +817,12 @@ static void lovrGraphicsBatch(BatchRequest* req) {
   Batch* batch = NULL;
   for (int i = state.batchCount - 1; i >= 0; i--) {
     if (req->type == BATCH_MESH && req->params.mesh.instances > 1) { break; }
+    if (skinned && poseStart == ~0u) { break; }
 
     Batch* b = &state.batches[i];
     if (b->type != req->type) { goto next; }
     if (b->drawCount >= MAX_DRAWS) { goto next; }
+    if (b->poseStart != poseStart) { goto next; }
     if (b->draw.mesh != mesh) { goto next; }
     if (b->draw.canvas != canvas) { goto next; }
     if (b->draw.shader != shader) { goto next; }
@@ -636,13 +854,23 @@ next:
   bool needFlush = false;
   bool hasVertices = req->vertexCount > 0 && (!req->instanced || !batch);
   bool hasIndices = hasVertices && req->indexCount > 0;
-  needFlush = needFlush || (hasVertices && state.head[STREAM_VERTEX] + req->vertexCount > bufferCount[STREAM_VERTEX]);
-  needFlush = needFlush || (hasVertices && state.head[STREAM_DRAWID] + req->vertexCount > bufferCount[STREAM_DRAWID]);
-  needFlush = needFlush || (hasIndices && state.head[STREAM_INDEX] + req->indexCount > bufferCount[STREAM_INDEX]);
+  bool hasPose = skinned && poseStart == ~0u;
+  uint32_t poseCount = ALIGN(req->params.mesh.poseCount, state.poseAlign);
+  uint32_t poseHead = ALIGN(state.head[STREAM_POSE], state.poseAlign);
+  needFlush = needFlush || (hasVertices && state.head[STREAM_VERTEX] + req->vertexCount > state.bufferCount[STREAM_VERTEX]);
+  needFlush = needFlush || (hasVertices && state.head[STREAM_DRAWID] + req->vertexCount > state.bufferCount[STREAM_DRAWID]);
+  needFlush = needFlush || (hasIndices && state.head[STREAM_INDEX] + req->indexCount > state.bufferCount[STREAM_INDEX]);
   needFlush = needFlush || (!batch && state.batchCount >= MAX_BATCHES);
-  needFlush = needFlush || (!batch && state.head[STREAM_MODEL] + MAX_DRAWS > bufferCount[STREAM_MODEL]);
-  needFlush = needFlush || (!batch && state.head[STREAM_COLOR] + MAX_DRAWS > bufferCount[STREAM_COLOR]);
-  if (needFlush) lovrGraphicsFlush();
+  needFlush = needFlush || (!batch && state.head[STREAM_MODEL] + MAX_DRAWS > state.bufferCount[STREAM_MODEL]);
+  needFlush = needFlush || (!batch && state.head[STREAM_COLOR] + MAX_DRAWS > state.bufferCount[STREAM_COLOR]);
+  needFlush = needFlush || (hasPose && poseHead + poseCount > state.bufferCount[STREAM_POSE]);
+  if (needFlush) {
+    lovrGraphicsFlush();
+    if (poseStart != ~0u && isPoseFenced(poseStart)) {
+      poseStart = ~0u;
+      hasPose = true;
+    }
+  }
 
   if (req->vertexCount > 0 && (!req->instanced || !batch)) {
     *(req->vertices) = lovrGraphicsMapBuffer(STREAM_VERTEX, req->vertexCount);
@@ -654,6 +882,19 @@ next:
     }
   }
 
+  // Palettes only take up as many matrices as the skin has joints, rounded up to the block alignment
+  if (hasPose) {
+    state.head[STREAM_POSE] = poseHead;
+    float* pose = lovrGraphicsMapBuffer(STREAM_POSE, poseCount);
+    memcpy(pose, req->params.mesh.pose, req->params.mesh.poseCount * 16 * sizeof(float));
+    poseStart = state.head[STREAM_POSE];
+    state.head[STREAM_POSE] += poseCount;
+
+    if (poseHash) {
+      map_set(&state.poses, poseHash, poseStart);
+    }
+  }
+
   // Start a new batch
   if (!batch || state.batchCount == 0) {
     float* transforms = lovrGraphicsMapBuffer(STREAM_MODEL, MAX_DRAWS);
@@ -688,6 +929,7 @@ next:
       .transforms = transforms,
       .colors = colors,
       .drawStart = state.head[STREAM_MODEL],
+      .poseStart = poseStart,
       .indexed = req->indexCount > 0
     };
 
@@ -696,16 +938,10 @@ next:
   }
 
   // Transform
-  if (req->transform) {
-    float transform[16];
-    mat4_multiply(mat4_init(transform, state.transforms[state.transform]), req->transform);
-    memcpy(&batch->transforms[16 * batch->drawCount], transform, 16 * sizeof(float));
-  } else {
-    memcpy(&batch->transforms[16 * batch->drawCount], state.transforms[state.transform], 16 * sizeof(float));
-  }
+  memcpy(&batch->transforms[16 * batch->drawCount], ctx->transform, 16 * sizeof(float));
 
   // Color
-  batch->colors[batch->drawCount] = state.linearColor;
+  batch->colors[batch->drawCount] = ctx->color;
 
   // Cursors
   if (!req->instanced || batch->drawCount == 0) {
@@ -726,7 +962,250 @@ next:
   batch->drawCount++;
 }
 
+// Sort keys are laid out so that draws are grouped by canvas, then opaque draws are sorted by
+// shader, pipeline, material, mesh, and front-to-back depth.  Draws that can't be reordered
+// (blending is on or depth test is off) are sorted after the opaque draws in submission order.
+// Objects are hashed into their bit ranges, so collisions only cost a bit of extra state changes.
+static uint64_t lovrGraphicsGetSortKey(BatchRequest* req, BatchContext* ctx, uint32_t sequence) {
+  bool ordered = ctx->pipeline.blendMode != BLEND_NONE || ctx->pipeline.depthTest == COMPARE_NONE;
+  uint64_t key = (hash64(&ctx->canvas, sizeof(Canvas*)) & 0xf) << 60 | (uint64_t) ordered << 59;
+
+  if (ordered) {
+    return key | sequence;
+  }
+
+  struct { Pipeline pipeline; BatchType type; BatchParams params; } batchState;
+  memset(&batchState, 0, sizeof(batchState));
+  batchState.pipeline = ctx->pipeline;
+  batchState.type = req->type;
+  batchState.params = req->params;
+
+  // The default material uses the texture of the request, so it is part of the material's key
+  void* material[2] = { ctx->material, req->material ? NULL : req->texture };
+
+  // View space depth of the origin, using the bits of a positive float as an ordered integer
+  float* view = state.frameData.viewMatrix[0];
+  float* m = ctx->transform;
+  union { float f; uint32_t u; } depth;
+  depth.f = MAX(-(view[2] * m[12] + view[6] * m[13] + view[10] * m[14] + view[14]), 0.f);
+
+  key |= (hash64(&ctx->shader, sizeof(Shader*)) & 0x3ff) << 49;
+  key |= (hash64(&batchState, sizeof(batchState)) & 0xff) << 41;
+  key |= (hash64(material, sizeof(material)) & 0xfff) << 29;
+  key |= (hash64(&ctx->mesh, sizeof(Mesh*)) & 0x1fff) << 16;
+  key |= depth.u >> 16;
+  return key;
+}
+
+static void lovrGraphicsEnqueue(BatchRequest* req, BatchContext* ctx) {
+  QueuedDraw draw = {
+    .request = *req,
+    .context = *ctx,
+    .vertexStart = ~0u,
+    .indexStart = ~0u,
+    .poseStart = ~0u
+  };
+
+  draw.request.pipeline = NULL;
+  draw.request.transform = NULL;
+  draw.request.vertices = NULL;
+  draw.request.indices = NULL;
+  draw.request.baseVertex = NULL;
+
+  // The pose is owned by the caller, so it needs to be copied until the queue is submitted.  Draws
+  // of the same palette version share a copy, which keeps them batchable after replay.
+  if (req->type == BATCH_MESH && req->params.mesh.pose) {
+    uint32_t version = req->params.mesh.poseVersion;
+    uint64_t hash = hash64(&version, sizeof(version));
+    uint64_t cached = version ? map_get(&state.queuePalettes, hash) : MAP_NIL;
+
+    if (cached != MAP_NIL) {
+      draw.poseStart = (uint32_t) cached;
+    } else {
+      draw.poseStart = state.queuePoses.length;
+      arr_append(&state.queuePoses, req->params.mesh.pose, req->params.mesh.poseCount * 16);
+      if (version) map_set(&state.queuePalettes, hash, draw.poseStart);
+    }
+
+    draw.request.params.mesh.pose = NULL;
+  }
+
+  // Vertices are written to the queue and copied to the vertex stream when the queue is submitted.
+  // Instanced geometry only depends on the parameters, so it's only written once per queue.
+  if (req->vertexCount > 0) {
+    uint64_t hash = 0;
+
+    if (req->instanced) {
+      struct { BatchType type; BatchParams params; } geometry;
+      memset(&geometry, 0, sizeof(geometry));
+      geometry.type = req->type;
+      geometry.params = req->params;
+      hash = hash64(&geometry, sizeof(geometry));
+      uint64_t cached = map_get(&state.queueGeometry, hash);
+
+      if (cached != MAP_NIL) {
+        draw.vertexStart = (uint32_t) (cached & 0xffffffff);
+        draw.indexStart = (uint32_t) (cached >> 32);
+        *(req->vertices) = NULL;
+        hash = 0;
+      }
+    }
+
+    if (draw.vertexStart == ~0u) {
+      draw.vertexStart = state.queueVertices.length / 8;
+      arr_expand(&state.queueVertices, 8 * req->vertexCount);
+      *(req->vertices) = state.queueVertices.data + state.queueVertices.length;
+      state.queueVertices.length += 8 * req->vertexCount;
+
+      if (req->indexCount > 0) {
+        draw.indexStart = state.queueIndices.length;
+        arr_expand(&state.queueIndices, req->indexCount);
+        *(req->indices) = state.queueIndices.data + state.queueIndices.length;
+        *(req->baseVertex) = 0;
+        state.queueIndices.length += req->indexCount;
+      }
+
+      if (hash) {
+        map_set(&state.queueGeometry, hash, ((uint64_t) draw.indexStart << 32) | draw.vertexStart);
+      }
+    }
+  }
+
+  lovrRetain(req->texture);
+  arr_push(&state.queue, draw);
+}
+
+static void lovrGraphicsSortQueue(SortKey* keys, SortKey* scratch, uint32_t count) {
+  SortKey* src = keys;
+  SortKey* dst = scratch;
+
+  // LSD radix sort, one byte at a time, skipping bytes that are the same for every key
+  for (uint32_t shift = 0; shift < 64; shift += 8) {
+    uint32_t offsets[256] = { 0 };
+
+    for (uint32_t i = 0; i < count; i++) {
+      offsets[(src[i].key >> shift) & 0xff]++;
+    }
+
+    if (offsets[(src[0].key >> shift) & 0xff] == count) {
+      continue;
+    }
+
+    for (uint32_t i = 0, total = 0; i < 256; i++) {
+      uint32_t n = offsets[i];
+      offsets[i] = total;
+      total += n;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+      dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
+    }
+
+    SortKey* tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+
+  if (src != keys) {
+    memcpy(keys, src, count * sizeof(SortKey));
+  }
+}
+
+static void lovrGraphicsSubmitQueue() {
+  uint32_t count = state.queue.length;
+
+  if (count == 0) {
+    return;
+  }
+
+  arr_reserve(&state.sortKeys, 2 * count);
+  SortKey* keys = state.sortKeys.data;
+  SortKey* scratch = state.sortKeys.data + count;
+
+  for (uint32_t i = 0; i < count; i++) {
+    QueuedDraw* draw = &state.queue.data[i];
+    keys[i].key = lovrGraphicsGetSortKey(&draw->request, &draw->context, i);
+    keys[i].index = i;
+  }
+
+  lovrGraphicsSortQueue(keys, scratch, count);
+
+  // Draws are submitted to the batcher in sorted order, which coalesces runs of compatible draws.
+  // Any flushes triggered while doing this only flush batches and never recurse into the queue.
+  state.replaying = true;
+
+  for (uint32_t i = 0; i < count; i++) {
+    QueuedDraw* draw = &state.queue.data[keys[i].index];
+    BatchRequest req = draw->request;
+    float* vertices = NULL;
+    uint32_t* indices = NULL;
+    uint32_t baseVertex = 0;
+
+    req.vertices = &vertices;
+    req.indices = &indices;
+    req.baseVertex = &baseVertex;
+
+    if (draw->poseStart != ~0u) {
+      req.params.mesh.pose = state.queuePoses.data + draw->poseStart;
+    }
+
+    lovrGraphicsSubmit(&req, &draw->context);
+
+    if (vertices) {
+      memcpy(vertices, state.queueVertices.data + 8 * draw->vertexStart, 8 * req.vertexCount * sizeof(float));
+    }
+
+    if (indices) {
+      uint32_t* source = state.queueIndices.data + draw->indexStart;
+      for (uint32_t j = 0; j < req.indexCount; j++) {
+        indices[j] = source[j] == 0xffffffff ? 0xffffffff : source[j] + baseVertex;
+      }
+    }
+
+    lovrRelease(Texture, draw->request.texture);
+  }
+
+  state.replaying = false;
+  arr_clear(&state.queue);
+  arr_clear(&state.queueVertices);
+  arr_clear(&state.queueIndices);
+  arr_clear(&state.queuePoses);
+  map_free(&state.queuePalettes);
+  map_init(&state.queuePalettes, 0);
+  map_free(&state.queueGeometry);
+  map_init(&state.queueGeometry, 0);
+}
+
+static void lovrGraphicsBatch(BatchRequest* req) {
+  BatchContext ctx;
+
+  // Resolve objects
+  ctx.mesh = req->mesh ? req->mesh : (req->instanced ? state.instancedMesh : state.mesh);
+  ctx.canvas = state.canvas ? state.canvas : state.backbuffer;
+  bool stereo = lovrCanvasIsStereo(ctx.canvas);
+  ctx.shader = state.shader ? state.shader : (state.defaultShaders[req->shader][stereo] ? state.defaultShaders[req->shader][stereo] : (state.defaultShaders[req->shader][stereo] = lovrShaderCreateDefault(req->shader, NULL, 0, stereo)));
+  ctx.pipeline = req->pipeline ? *req->pipeline : state.pipeline;
+  ctx.material = req->material ? req->material : (state.defaultMaterial ? state.defaultMaterial : (state.defaultMaterial = lovrMaterialCreate()));
+  ctx.color = state.linearColor;
+
+  if (req->transform) {
+    mat4_multiply(mat4_init(ctx.transform, state.transforms[state.transform]), req->transform);
+  } else {
+    mat4_init(ctx.transform, state.transforms[state.transform]);
+  }
+
+  if (state.sorting && !state.replaying) {
+    lovrGraphicsEnqueue(req, &ctx);
+  } else {
+    lovrGraphicsSubmit(req, &ctx);
+  }
+}
+
 void lovrGraphicsFlush() {
+  if (!state.replaying) {
+    lovrGraphicsSubmitQueue();
+  }
+
   if (state.batchCount == 0) {
     return;
   }
@@ -742,9 +1221,16 @@ void lovrGraphicsFlush() {
     state.head[STREAM_FRAME]++;
   }
 
+  if (state.bufferStride[STREAM_INDEX] == sizeof(uint16_t) && state.head[STREAM_INDEX] > state.tail[STREAM_INDEX]) {
+    uint16_t* indices = lovrBufferMap(state.buffers[STREAM_INDEX], state.tail[STREAM_INDEX] * sizeof(uint16_t), true);
+    for (uint32_t i = state.tail[STREAM_INDEX]; i < state.head[STREAM_INDEX]; i++) {
+      *indices++ = (uint16_t) state.indexStaging[i];
+    }
+  }
+
   // Flush buffers
   for (int i = 0; i < MAX_STREAMS; i++) {
-    lovrBufferFlush(state.buffers[i], state.tail[i] * bufferStride[i], (state.head[i] - state.tail[i]) * bufferStride[i]);
+    lovrBufferFlush(state.buffers[i], state.tail[i] * state.bufferStride[i], (state.head[i] - state.tail[i]) * state.bufferStride[i]);
     lovrBufferUnmap(state.buffers[i]);
     state.tail[i] = state.head[i];
   }
@@ -754,9 +1240,14 @@ void lovrGraphicsFlush() {
 
     // Uniforms
     lovrMaterialBind(batch->material, batch->draw.shader);
-    lovrShaderSetBlock(batch->draw.shader, "lovrModelBlock", state.buffers[STREAM_MODEL], batch->drawStart * bufferStride[STREAM_MODEL], MAX_DRAWS * bufferStride[STREAM_MODEL], ACCESS_READ);
-    lovrShaderSetBlock(batch->draw.shader, "lovrColorBlock", state.buffers[STREAM_COLOR], batch->drawStart * bufferStride[STREAM_COLOR], MAX_DRAWS * bufferStride[STREAM_COLOR], ACCESS_READ);
-    lovrShaderSetBlock(batch->draw.shader, "lovrFrameBlock", state.buffers[STREAM_FRAME], (state.head[STREAM_FRAME] - 1) * bufferStride[STREAM_FRAME], bufferStride[STREAM_FRAME], ACCESS_READ);
+    lovrShaderSetBlock(batch->draw.shader, "lovrModelBlock", state.buffers[STREAM_MODEL], batch->drawStart * state.bufferStride[STREAM_MODEL], MAX_DRAWS * state.bufferStride[STREAM_MODEL], ACCESS_READ);
+    lovrShaderSetBlock(batch->draw.shader, "lovrColorBlock", state.buffers[STREAM_COLOR], batch->drawStart * state.bufferStride[STREAM_COLOR], MAX_DRAWS * state.bufferStride[STREAM_COLOR], ACCESS_READ);
+    lovrShaderSetBlock(batch->draw.shader, "lovrFrameBlock", state.buffers[STREAM_FRAME], (state.head[STREAM_FRAME] - 1) * state.bufferStride[STREAM_FRAME], state.bufferStride[STREAM_FRAME], ACCESS_READ);
+    if (batch->poseStart != ~0u) {
+      lovrShaderSetBlock(batch->draw.shader, "lovrPoseBlock", state.buffers[STREAM_POSE], batch->poseStart * state.bufferStride[STREAM_POSE], MAX_BONES * state.bufferStride[STREAM_POSE], ACCESS_READ);
+    } else {
+      lovrShaderSetBlock(batch->draw.shader, "lovrPoseBlock", state.identityPose, 0, MAX_BONES * state.bufferStride[STREAM_POSE], ACCESS_READ);
+    }
     if (batch->draw.topology == DRAW_POINTS) {
       lovrShaderSetFloats(batch->draw.shader, "lovrPointSize", &state.pointSize, 0, 1);
     }
@@ -770,7 +1261,7 @@ void lovrGraphicsFlush() {
       }
 
       if (batch->indexed) {
-        lovrMeshSetIndexBuffer(batch->draw.mesh, state.buffers[STREAM_INDEX], bufferCount[STREAM_INDEX], sizeof(uint16_t), 0);
+        lovrMeshSetIndexBuffer(batch->draw.mesh, state.buffers[STREAM_INDEX], state.bufferCount[STREAM_INDEX], state.bufferStride[STREAM_INDEX], 0);
       } else {
         lovrMeshSetIndexBuffer(batch->draw.mesh, NULL, 0, 0, 0);
       }
@@ -778,6 +1269,10 @@ void lovrGraphicsFlush() {
 
     lovrGpuDraw(&batch->draw);
   }
+
+  for (int i = 0; i < MAX_STREAMS; i++) {
+    lovrGraphicsLockBuffer(i, state.head[i] / lockSize(i));
+  }
 }
 
 void lovrGraphicsFlushCanvas(Canvas* canvas) {
@@ -787,6 +1282,13 @@ void lovrGraphicsFlushCanvas(Canvas* canvas) {
       return;
     }
   }
+
+  for (size_t i = 0; !state.replaying && i < state.queue.length; i++) {
+    if (state.queue.data[i].context.canvas == canvas) {
+      lovrGraphicsFlush();
+      return;
+    }
+  }
 }
 
 void lovrGraphicsFlushShader(Shader* shader) {
@@ -796,6 +1298,13 @@ void lovrGraphicsFlushShader(Shader* shader) {
       return;
     }
   }
+
+  for (size_t i = 0; !state.replaying && i < state.queue.length; i++) {
+    if (state.queue.data[i].context.shader == shader) {
+      lovrGraphicsFlush();
+      return;
+    }
+  }
 }
 
 void lovrGraphicsFlushMaterial(Material* material) {
@@ -805,6 +1314,13 @@ void lovrGraphicsFlushMaterial(Material* material) {
       return;
     }
   }
+
+  for (size_t i = 0; !state.replaying && i < state.queue.length; i++) {
+    if (state.queue.data[i].context.material == material) {
+      lovrGraphicsFlush();
+      return;
+    }
+  }
 }
 
 void lovrGraphicsFlushMesh(Mesh* mesh) {
@@ -814,6 +1330,13 @@ void lovrGraphicsFlushMesh(Mesh* mesh) {
       return;
     }
   }
+
+  for (size_t i = 0; !state.replaying && i < state.queue.length; i++) {
+    if (state.queue.data[i].context.mesh == mesh) {
+      lovrGraphicsFlush();
+      return;
+    }
+  }
 }
 
 void lovrGraphicsClear(Color* color, float* depth, int* stencil) {
@@ -840,8 +1363,8 @@ void lovrGraphicsPoints(uint32_t count, float** vertices) {
 
 void lovrGraphicsLine(uint32_t count, float** vertices) {
   uint32_t indexCount = count + 1;
-  uint16_t* indices;
-  uint16_t baseVertex;
+  uint32_t* indices;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_LINES,
@@ -853,7 +1376,7 @@ void lovrGraphicsLine(uint32_t count, float** vertices) {
     .baseVertex = &baseVertex
   });
 
-  indices[0] = 0xffff;
+  indices[0] = 0xffffffff;
   for (uint32_t i = 1; i < indexCount; i++) {
     indices[i] = baseVertex + i - 1;
   }
@@ -861,8 +1384,8 @@ void lovrGraphicsLine(uint32_t count, float** vertices) {
 
 void lovrGraphicsTriangle(DrawStyle style, Material* material, uint32_t count, float** vertices) {
   uint32_t indexCount = style == STYLE_LINE ? (4 * count / 3) : 0;
-  uint16_t* indices;
-  uint16_t baseVertex;
+  uint32_t* indices;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_TRIANGLES,
@@ -878,7 +1401,7 @@ void lovrGraphicsTriangle(DrawStyle style, Material* material, uint32_t count, f
 
   if (style == STYLE_LINE) {
     for (uint32_t i = 0; i < count; i += 3) {
-      *indices++ = 0xffff;
+      *indices++ = 0xffffffff;
       *indices++ = baseVertex + i + 0;
       *indices++ = baseVertex + i + 1;
       *indices++ = baseVertex + i + 2;
@@ -888,8 +1411,8 @@ void lovrGraphicsTriangle(DrawStyle style, Material* material, uint32_t count, f
 
 void lovrGraphicsPlane(DrawStyle style, Material* material, mat4 transform, float u, float v, float w, float h) {
   float* vertices = NULL;
-  uint16_t* indices = NULL;
-  uint16_t baseVertex;
+  uint32_t* indices = NULL;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_PLANE,
@@ -914,7 +1437,7 @@ void lovrGraphicsPlane(DrawStyle style, Material* material, mat4 transform, floa
 
     memcpy(vertices, vertexData, sizeof(vertexData));
 
-    indices[0] = 0xffff;
+    indices[0] = 0xffffffff;
     indices[1] = 0 + baseVertex;
     indices[2] = 1 + baseVertex;
     indices[3] = 2 + baseVertex;
@@ -929,7 +1452,7 @@ void lovrGraphicsPlane(DrawStyle style, Material* material, mat4 transform, floa
 
     memcpy(vertices, vertexData, sizeof(vertexData));
 
-    static uint16_t indexData[] = { 0, 1, 2, 2, 1, 3 };
+    static uint32_t indexData[] = { 0, 1, 2, 2, 1, 3 };
 
     for (size_t i = 0; i < sizeof(indexData) / sizeof(indexData[0]); i++) {
       indices[i] = indexData[i] + baseVertex;
@@ -939,8 +1462,8 @@ void lovrGraphicsPlane(DrawStyle style, Material* material, mat4 transform, floa
 
 void lovrGraphicsBox(DrawStyle style, Material* material, mat4 transform) {
   float* vertices = NULL;
-  uint16_t* indices = NULL;
-  uint16_t baseVertex;
+  uint32_t* indices = NULL;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_BOX,
@@ -971,7 +1494,7 @@ void lovrGraphicsBox(DrawStyle style, Material* material, mat4 transform) {
 
       memcpy(vertices, vertexData, sizeof(vertexData));
 
-      static uint16_t indexData[] = {
+      static uint32_t indexData[] = {
         0, 1, 1, 2, 2, 3, 3, 0, // Front
         4, 5, 5, 6, 6, 7, 7, 4, // Back
         0, 4, 1, 5, 2, 6, 3, 7  // Connections
@@ -1010,7 +1533,7 @@ void lovrGraphicsBox(DrawStyle style, Material* material, mat4 transform) {
 
       memcpy(vertices, vertexData, sizeof(vertexData));
 
-      uint16_t indexData[] = {
+      uint32_t indexData[] = {
         0,  1,   2,  2,  1,  3,
         4,  5,   6,  6,  5,  7,
         8,  9,  10, 10,  9, 11,
@@ -1085,8 +1608,8 @@ void lovrGraphicsCylinder(Material* material, mat4 transform, float r1, float r2
   uint32_t vertexCount = ((capped && r1) * (segments + 2) + (capped && r2) * (segments + 2) + 2 * (segments + 1));
   uint32_t indexCount = 3 * segments * ((capped && r1) + (capped && r2) + 2);
   float* vertices = NULL;
-  uint16_t* indices = NULL;
-  uint16_t baseVertex;
+  uint32_t* indices = NULL;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_CYLINDER,
@@ -1147,16 +1670,16 @@ void lovrGraphicsCylinder(Material* material, mat4 transform, float r1, float r2
     // Indices
     for (int i = 0; i < segments; i++) {
       int j = 2 * i + baseVertex;
-      memcpy(indices, (uint16_t[6]) { j, j + 2, j + 1, j + 1, j + 2, j + 3 }, 6 * sizeof(uint16_t));
+      memcpy(indices, (uint32_t[6]) { j, j + 2, j + 1, j + 1, j + 2, j + 3 }, 6 * sizeof(uint32_t));
       indices += 6;
 
       if (capped && r1 != 0.f) {
-        memcpy(indices, (uint16_t[3]) { top, top + i + 2, top + i + 1 }, 3 * sizeof(uint16_t));
+        memcpy(indices, (uint32_t[3]) { top, top + i + 2, top + i + 1 }, 3 * sizeof(uint32_t));
         indices += 3;
       }
 
       if (capped && r2 != 0.f) {
-        memcpy(indices, (uint16_t[3]) { bot, bot + i + 1, bot + i + 2 }, 3 * sizeof(uint16_t));
+        memcpy(indices, (uint32_t[3]) { bot, bot + i + 1, bot + i + 2 }, 3 * sizeof(uint32_t));
         indices += 3;
       }
     }
@@ -1165,8 +1688,8 @@ void lovrGraphicsCylinder(Material* material, mat4 transform, float r1, float r2
 
 void lovrGraphicsSphere(Material* material, mat4 transform, int segments) {
   float* vertices = NULL;
-  uint16_t* indices = NULL;
-  uint16_t baseVertex;
+  uint32_t* indices = NULL;
+  uint32_t baseVertex;
 
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_SPHERE,
@@ -1198,12 +1721,12 @@ void lovrGraphicsSphere(Material* material, mat4 transform, int segments) {
     }
 
     for (int i = 0; i < segments; i++) {
-      uint16_t offset0 = i * (segments + 1) + baseVertex;
-      uint16_t offset1 = (i + 1) * (segments + 1) + baseVertex;
+      uint32_t offset0 = i * (segments + 1) + baseVertex;
+      uint32_t offset1 = (i + 1) * (segments + 1) + baseVertex;
       for (int j = 0; j < segments; j++) {
-        uint16_t i0 = offset0 + j;
-        uint16_t i1 = offset1 + j;
-        memcpy(indices, ((uint16_t[]) { i0, i0 + 1, i1, i1, i0 + 1, i1 + 1 }), 6 * sizeof(uint16_t));
+        uint32_t i0 = offset0 + j;
+        uint32_t i1 = offset1 + j;
+        memcpy(indices, ((uint32_t[]) { i0, i0 + 1, i1, i1, i0 + 1, i1 + 1 }), 6 * sizeof(uint32_t));
         indices += 6;
       }
     }
@@ -1262,8 +1785,8 @@ void lovrGraphicsPrint(const char* str, size_t length, mat4 transform, float wra
   pipeline.blendMode = pipeline.blendMode == BLEND_NONE ? BLEND_ALPHA : pipeline.blendMode;
 
   float* vertices;
-  uint16_t* indices;
-  uint16_t baseVertex;
+  uint32_t* indices;
+  uint32_t baseVertex;
   lovrGraphicsBatch(&(BatchRequest) {
     .type = BATCH_TEXT,
     .topology = DRAW_TRIANGLES,
@@ -1309,7 +1832,7 @@ void lovrGraphicsFill(Texture* texture, float u, float v, float w, float h) {
   }
 }
 
-void lovrGraphicsDrawMesh(Mesh* mesh, mat4 transform, uint32_t instances, float* pose) {
+void lovrGraphicsDrawMesh(Mesh* mesh, mat4 transform, uint32_t instances, float* pose, uint32_t poseCount, uint32_t poseVersion) {
   uint32_t vertexCount = lovrMeshGetVertexCount(mesh);
   uint32_t indexCount = lovrMeshGetIndexCount(mesh);
   uint32_t defaultCount = indexCount > 0 ? indexCount : vertexCount;
@@ -1325,6 +1848,8 @@ void lovrGraphicsDrawMesh(Mesh* mesh, mat4 transform, uint32_t instances, float*
     .params.mesh.rangeCount = rangeCount,
     .params.mesh.instances = instances,
     .params.mesh.pose = pose,
+    .params.mesh.poseCount = poseCount,
+    .params.mesh.poseVersion = poseVersion,
     .mesh = mesh,
     .topology = mode,
     .transform = transform,
@@ -1332,3 +1857,47 @@ void lovrGraphicsDrawMesh(Mesh* mesh, mat4 transform, uint32_t instances, float*
     .instanced = instances <= 1
   });
 }
+
+// Returns the planes of the view frustums in the coordinate space of the current transform, so
+// bounding boxes can be tested without transforming them.  Stereo canvases test both eyes.
+void lovrGraphicsGetFrustum(Frustum* frustum) {
+  Canvas* canvas = state.canvas ? state.canvas : state.backbuffer;
+  frustum->viewCount = lovrCanvasIsStereo(canvas) ? 2 : 1;
+
+  for (uint32_t i = 0; i < frustum->viewCount; i++) {
+    float m[16];
+    mat4_init(m, state.frameData.projection[i]);
+    mat4_multiply(m, state.frameData.viewMatrix[i]);
+    mat4_multiply(m, state.transforms[state.transform]);
+
+    // Each plane is the 4th row of the matrix plus or minus one of the other rows
+    for (uint32_t j = 0; j < 6; j++) {
+      float sign = (j & 1) ? -1.f : 1.f;
+      for (uint32_t k = 0; k < 4; k++) {
+        frustum->planes[i][j][k] = m[4 * k + 3] + sign * m[4 * k + j / 2];
+      }
+    }
+  }
+}
+
+// Returns true if the box (minx, maxx, miny, maxy, minz, maxz) is outside every view
+bool lovrGraphicsCull(Frustum* frustum, float aabb[6]) {
+  for (uint32_t i = 0; i < frustum->viewCount; i++) {
+    bool visible = true;
+
+    for (uint32_t j = 0; j < 6 && visible; j++) {
+      float* p = frustum->planes[i][j];
+      float x = p[0] > 0.f ? aabb[1] : aabb[0];
+      float y = p[1] > 0.f ? aabb[3] : aabb[2];
+      float z = p[2] > 0.f ? aabb[5] : aabb[4];
+      visible = p[0] * x + p[1] * y + p[2] * z + p[3] >= 0.f;
+    }
+
+    if (visible) {
+      return false;
+    }
+  }
+
+  state.culledCount++;
+  return true;
+}
@@ -84,8 +84,13 @@ typedef struct {
   unsigned wireframe : 1;
 } Pipeline;
 
+typedef struct {
+  float planes[2][6][4];
+  uint32_t viewCount;
+} Frustum;
+
 // Base
-bool lovrGraphicsInit(bool debug);
+bool lovrGraphicsInit(bool debug, uint32_t vertexCount, uint32_t indexCount);
 void lovrGraphicsDestroy(void);
 void lovrGraphicsPresent(void);
 void lovrGraphicsCreateWindow(WindowFlags* flags);
@@ -102,7 +107,7 @@ struct Buffer* lovrGraphicsGetIdentityBuffer(void);
 #define lovrGraphicsTock lovrGpuTock
 #define lovrGraphicsGetFeatures lovrGpuGetFeatures
 #define lovrGraphicsGetLimits lovrGpuGetLimits
-#define lovrGraphicsGetStats lovrGpuGetStats
+uint32_t lovrGraphicsGetCulledCount(void);
 
 // State
 void lovrGraphicsReset(void);
@@ -132,6 +137,8 @@ float lovrGraphicsGetPointSize(void);
 void lovrGraphicsSetPointSize(float size);
 struct Shader* lovrGraphicsGetShader(void);
 void lovrGraphicsSetShader(struct Shader* shader);
+bool lovrGraphicsIsSortingEnabled(void);
+void lovrGraphicsSetSortingEnabled(bool sorting);
 void lovrGraphicsGetStencilTest(CompareMode* mode, int* value);
 void lovrGraphicsSetStencilTest(CompareMode mode, int value);
 Winding lovrGraphicsGetWinding(void);
@@ -168,7 +175,9 @@ void lovrGraphicsSphere(struct Material* material, mat4 transform, int segments)
 void lovrGraphicsSkybox(struct Texture* texture);
 void lovrGraphicsPrint(const char* str, size_t length, mat4 transform, float wrap, HorizontalAlign halign, VerticalAlign valign);
 void lovrGraphicsFill(struct Texture* texture, float u, float v, float w, float h);
-void lovrGraphicsDrawMesh(struct Mesh* mesh, mat4 transform, uint32_t instances, float* pose);
+void lovrGraphicsDrawMesh(struct Mesh* mesh, mat4 transform, uint32_t instances, float* pose, uint32_t poseCount, uint32_t poseVersion);
+void lovrGraphicsGetFrustum(Frustum* frustum);
+bool lovrGraphicsCull(Frustum* frustum, float aabb[6]);
 #define lovrGraphicsStencil lovrGpuStencil
 #define lovrGraphicsCompute lovrGpuCompute
 
@@ -201,8 +210,14 @@ typedef struct {
   uint32_t textureCount;
   uint64_t bufferMemory;
   uint64_t textureMemory;
+  uint32_t fenceCount;
+  uint32_t fenceStalls;
+  uint64_t streamMemory;
+  uint64_t streamPeak;
 } GpuStats;
 
+const GpuStats* lovrGraphicsGetStats(void);
+
 typedef struct {
   struct Mesh* mesh;
   struct Canvas* canvas;
@@ -222,6 +237,9 @@ void lovrGpuDiscard(struct Canvas* canvas, bool color, bool depth, bool stencil)
 void lovrGpuDraw(DrawCommand* draw);
 void lovrGpuStencil(StencilAction action, int replaceValue, StencilCallback callback, void* userdata);
 void lovrGpuPresent(void);
+void* lovrGpuFence(void);
+bool lovrGpuWait(void* fence, bool block);
+void lovrGpuDestroyFence(void* fence);
 void lovrGpuDirtyTexture(void);
 void lovrGpuResetState(void);
 void lovrGpuTick(const char* label);
@@ -8,12 +8,11 @@
 #include "core/maf.h"
 #include "core/ref.h"
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
 #include <math.h>
 
-typedef struct {
-  float properties[3][4];
-} NodeTransform;
+#define BLEND_CHUNK_SIZE 64
 
 struct Model {
   struct ModelData* data;
@@ -21,57 +20,345 @@ struct Model {
   struct Mesh** meshes;
   struct Texture** textures;
   struct Material** materials;
-  NodeTransform* localTransforms;
+  float* localTransforms[3];
   float* globalTransforms;
+  float* primitiveBounds;
+  float* nodeBounds;
+  float* palettes;
+  uint32_t* paletteVersions;
+  uint32_t* nodeOrder;
+  uint32_t* nodeParents;
+  uint32_t nodeOrderCount;
+  uint8_t* dirty;
   bool transformsDirty;
+  AnimationState** animations;
 };
 
-static void updateGlobalTransform(Model* model, uint32_t nodeIndex, mat4 parent) {
-  mat4 global = model->globalTransforms + 16 * nodeIndex;
-  NodeTransform* local = &model->localTransforms[nodeIndex];
-  vec3 T = local->properties[PROP_TRANSLATION];
-  quat R = local->properties[PROP_ROTATION];
-  vec3 S = local->properties[PROP_SCALE];
+struct AnimationState {
+  struct ModelData* data;
+  uint32_t animation;
+  float duration;
+  float time;
+  ModelAnimationChannel** channels;
+  uint32_t channelCount;
+  uint32_t rotationCount;
+  uint32_t* cursors;
+  float* samples;
+};
 
-  mat4_init(global, parent);
-  mat4_translate(global, T[0], T[1], T[2]);
-  mat4_rotateQuat(global, R);
-  mat4_scale(global, S[0], S[1], S[2]);
+// Bounds are stored as (minx, maxx, miny, maxy, minz, maxz).  Primitives without a known extent
+// and skinned nodes get infinite bounds, which are never culled.
+static void transformBounds(float* bounds, mat4 m, float* local) {
+  if (isinf(local[0])) {
+    memcpy(bounds, local, 6 * sizeof(float));
+    return;
+  }
 
-  ModelNode* node = &model->data->nodes[nodeIndex];
-  for (uint32_t i = 0; i < node->childCount; i++) {
-    updateGlobalTransform(model, node->children[i], global);
+  for (uint32_t i = 0; i < 3; i++) {
+    bounds[2 * i + 0] = bounds[2 * i + 1] = m[12 + i];
+    for (uint32_t j = 0; j < 3; j++) {
+      float a = m[4 * j + i] * local[2 * j + 0];
+      float b = m[4 * j + i] * local[2 * j + 1];
+      bounds[2 * i + 0] += MIN(a, b);
+      bounds[2 * i + 1] += MAX(a, b);
+    }
   }
 }
 
-static void renderNode(Model* model, uint32_t nodeIndex, uint32_t instances) {
+static void mergeBounds(float* bounds, float* other) {
+  for (uint32_t i = 0; i < 3; i++) {
+    bounds[2 * i + 0] = MIN(bounds[2 * i + 0], other[2 * i + 0]);
+    bounds[2 * i + 1] = MAX(bounds[2 * i + 1], other[2 * i + 1]);
+  }
+}
+
+// Nodes are stored in topological order (parents before children), so a forward pass can push
+// transforms down the hierarchy and a backward pass can pull bounds up.  Only dirty nodes and
+// their descendants are updated.
+static void updateTransforms(Model* model) {
+  if (!model->transformsDirty) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < model->nodeOrderCount; i++) {
+    uint32_t index = model->nodeOrder[i];
+    uint32_t parent = model->nodeParents[index];
+
+    if (!model->dirty[index] && (parent == ~0u || !model->dirty[parent])) {
+      continue;
+    }
+
+    model->dirty[index] = 1;
+    float* T = model->localTransforms[PROP_TRANSLATION] + 4 * index;
+    float* R = model->localTransforms[PROP_ROTATION] + 4 * index;
+    float* S = model->localTransforms[PROP_SCALE] + 4 * index;
+
+    float local[16];
+    mat4_fromQuat(local, R);
+    local[0] *= S[0], local[1] *= S[0], local[2] *= S[0];
+    local[4] *= S[1], local[5] *= S[1], local[6] *= S[1];
+    local[8] *= S[2], local[9] *= S[2], local[10] *= S[2];
+    local[12] = T[0], local[13] = T[1], local[14] = T[2];
+
+    mat4 global = model->globalTransforms + 16 * index;
+    if (parent == ~0u) {
+      mat4_init(global, local);
+    } else {
+      mat4_init(global, model->globalTransforms + 16 * parent);
+      mat4_multiply(global, local);
+    }
+  }
+
+  // Skin palettes live in the same order as the joint array and are in model space, so they only
+  // need to be rebuilt when one of their joints moved.  This has to happen before the bounds pass,
+  // which also marks ancestors dirty.  Every rebuild gets a new version, unique across all Models,
+  // which lets the renderer upload a palette once and share it between draws.
+  static uint32_t paletteVersion;
+  for (uint32_t i = 0; i < model->data->skinCount; i++) {
+    ModelSkin* skin = &model->data->skins[i];
+
+    bool dirty = false;
+    for (uint32_t j = 0; j < skin->jointCount && !dirty; j++) {
+      dirty = model->dirty[skin->joints[j]];
+    }
+
+    if (!dirty) {
+      continue;
+    }
+
+    float* palette = model->palettes + 16 * (skin->joints - model->data->joints);
+    for (uint32_t j = 0; j < skin->jointCount; j++) {
+      mat4 joint = palette + 16 * j;
+      mat4_init(joint, model->globalTransforms + 16 * skin->joints[j]);
+      mat4_multiply(joint, skin->inverseBindMatrices + 16 * j);
+    }
+
+    model->paletteVersions[i] = ++paletteVersion;
+  }
+
+  for (uint32_t i = model->nodeOrderCount; i-- > 0;) {
+    uint32_t index = model->nodeOrder[i];
+
+    if (!model->dirty[index]) {
+      continue;
+    }
+
+    ModelNode* node = &model->data->nodes[index];
+    mat4 global = model->globalTransforms + 16 * index;
+    float* bounds = model->nodeBounds + 6 * index;
+    bounds[0] = bounds[2] = bounds[4] = FLT_MAX;
+    bounds[1] = bounds[3] = bounds[5] = -FLT_MAX;
+
+    for (uint32_t j = 0; j < node->primitiveCount; j++) {
+      float primitiveBounds[6];
+      transformBounds(primitiveBounds, global, model->primitiveBounds + 6 * (node->primitiveIndex + j));
+      mergeBounds(bounds, primitiveBounds);
+    }
+
+    if (node->skin != ~0u && node->primitiveCount > 0) {
+      bounds[0] = bounds[2] = bounds[4] = -INFINITY;
+      bounds[1] = bounds[3] = bounds[5] = INFINITY;
+    }
+
+    // Node bounds contain their children, so culling a node culls its whole subtree
+    for (uint32_t j = 0; j < node->childCount; j++) {
+      mergeBounds(bounds, model->nodeBounds + 6 * node->children[j]);
+    }
+
+    if (model->nodeParents[index] != ~0u) {
+      model->dirty[model->nodeParents[index]] = 1;
+    }
+  }
+
+  memset(model->dirty, 0, model->data->nodeCount * sizeof(uint8_t));
+  model->transformsDirty = false;
+}
+
+static void renderNode(Model* model, uint32_t nodeIndex, uint32_t instances, Frustum* frustum) {
+  float* bounds = model->nodeBounds + 6 * nodeIndex;
+  if (frustum && !isinf(bounds[0]) && lovrGraphicsCull(frustum, bounds)) {
+    return;
+  }
+
   ModelNode* node = &model->data->nodes[nodeIndex];
   mat4 globalTransform = model->globalTransforms + 16 * nodeIndex;
-  float poseMatrix[16 * MAX_BONES];
   float* pose = NULL;
+  uint32_t poseCount = 0;
+  uint32_t poseVersion = 0;
 
+  // Skinned vertices are moved entirely by the (model space) palette, so the node transform is unused
   if (node->skin != ~0u) {
+    static float identity[16] = MAT4_IDENTITY;
     ModelSkin* skin = &model->data->skins[node->skin];
-    pose = poseMatrix;
-
-    for (uint32_t j = 0; j < skin->jointCount; j++) {
-      mat4 globalJointTransform = model->globalTransforms + 16 * skin->joints[j];
-      mat4 inverseBindMatrix = skin->inverseBindMatrices + 16 * j;
-      mat4 jointPose = pose + 16 * j;
-
-      mat4_set(jointPose, globalTransform);
-      mat4_invert(jointPose);
-      mat4_multiply(jointPose, globalJointTransform);
-      mat4_multiply(jointPose, inverseBindMatrix);
-    }
+    pose = model->palettes + 16 * (skin->joints - model->data->joints);
+    poseCount = skin->jointCount;
+    poseVersion = model->paletteVersions[node->skin];
+    globalTransform = identity;
   }
 
   for (uint32_t i = 0; i < node->primitiveCount; i++) {
-    lovrGraphicsDrawMesh(model->meshes[node->primitiveIndex + i], globalTransform, instances, pose);
+    if (frustum && !pose && (node->primitiveCount > 1 || node->childCount > 0)) {
+      float primitiveBounds[6];
+      transformBounds(primitiveBounds, globalTransform, model->primitiveBounds + 6 * (node->primitiveIndex + i));
+      if (!isinf(primitiveBounds[0]) && lovrGraphicsCull(frustum, primitiveBounds)) {
+        continue;
+      }
+    }
+
+    lovrGraphicsDrawMesh(model->meshes[node->primitiveIndex + i], globalTransform, instances, pose, poseCount, poseVersion);
   }
 
   for (uint32_t i = 0; i < node->childCount; i++) {
-    renderNode(model, node->children[i], instances);
+    renderNode(model, node->children[i], instances, frustum);
+  }
+}
+
+// Returns the first keyframe at or after the time.  Animations are usually played forward in small
+// steps, so the keyframe from the last sample is checked first and a binary search is only needed
+// when the time jumps around.
+static uint32_t findKeyframe(ModelAnimationChannel* channel, float time, uint32_t* cursor) {
+  float* times = channel->times;
+  uint32_t count = channel->keyframeCount;
+  uint32_t lo = 0;
+  uint32_t hi = count;
+  uint32_t k = MIN(*cursor, count);
+
+  if (k == 0 || times[k - 1] < time) {
+    for (uint32_t steps = 0; k < count && times[k] < time; k++, steps++) {
+      if (steps == 2) {
+        lo = k;
+        goto search;
+      }
+    }
+    return *cursor = k;
+  } else {
+    hi = k - 1;
+  }
+
+search:
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if (times[mid] < time) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return *cursor = lo;
+}
+
+static void sampleChannel(ModelAnimationChannel* channel, uint32_t keyframe, float time, float* property) {
+  bool rotate = channel->property == PROP_ROTATION;
+  size_t n = 3 + rotate;
+  float* (*lerp)(float* a, float* b, float t) = rotate ? quat_slerp : vec3_lerp;
+
+  if (keyframe == 0 || keyframe >= channel->keyframeCount) {
+    size_t index = CLAMP(keyframe, 0, channel->keyframeCount - 1);
+
+    // For cubic interpolation, each keyframe has 3 parts, and the actual data is in the middle (*3, +1)
+    if (channel->smoothing == SMOOTH_CUBIC) {
+      index = 3 * index + 1;
+    }
+
+    memcpy(property, channel->data + index * n, n * sizeof(float));
+  } else {
+    float t1 = channel->times[keyframe - 1];
+    float t2 = channel->times[keyframe];
+    float z = (time - t1) / (t2 - t1);
+
+    switch (channel->smoothing) {
+      case SMOOTH_STEP:
+        memcpy(property, channel->data + (z >= .5f ? keyframe : keyframe - 1) * n, n * sizeof(float));
+        break;
+      case SMOOTH_LINEAR:
+        memcpy(property, channel->data + (keyframe - 1) * n, n * sizeof(float));
+        lerp(property, channel->data + keyframe * n, z);
+        break;
+      case SMOOTH_CUBIC: {
+        size_t stride = 3 * n;
+        float* p0 = channel->data + (keyframe - 1) * stride + 1 * n;
+        float* m0 = channel->data + (keyframe - 1) * stride + 2 * n;
+        float* p1 = channel->data + (keyframe - 0) * stride + 1 * n;
+        float* m1 = channel->data + (keyframe - 0) * stride + 0 * n;
+        float dt = t2 - t1;
+        float z2 = z * z;
+        float z3 = z2 * z;
+        float a = 2.f * z3 - 3.f * z2 + 1.f;
+        float b = 2.f * z3 - 3.f * z2 + 1.f;
+        float c = (-2.f * z3 + 3.f * z2);
+        float d = (z3 * -z2) * dt;
+        for (size_t j = 0; j < n; j++) {
+          property[j] = a * p0[j] + b * m0[j] + c * p1[j] + d * m1[j];
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+AnimationState* lovrAnimationStateCreate(ModelData* data, uint32_t animationIndex) {
+  lovrAssert(animationIndex < data->animationCount, "Invalid animation index '%d' (Model only has %d animations)", animationIndex, data->animationCount);
+  AnimationState* state = lovrAlloc(AnimationState);
+  ModelAnimation* animation = &data->animations[animationIndex];
+  state->data = data;
+  state->animation = animationIndex;
+  state->duration = animation->duration;
+  state->channelCount = animation->channelCount;
+  state->channels = malloc(animation->channelCount * sizeof(ModelAnimationChannel*));
+  state->cursors = calloc(animation->channelCount, sizeof(uint32_t));
+  state->samples = calloc(4 * animation->channelCount, sizeof(float));
+  lovrRetain(data);
+
+  for (uint32_t i = 0; i < animation->channelCount; i++) {
+    if (animation->channels[i].property == PROP_ROTATION) {
+      state->channels[state->rotationCount++] = &animation->channels[i];
+    }
+  }
+
+  for (uint32_t i = 0, j = state->rotationCount; i < animation->channelCount; i++) {
+    if (animation->channels[i].property != PROP_ROTATION) {
+      state->channels[j++] = &animation->channels[i];
+    }
+  }
+
+  return state;
+}
+
+void lovrAnimationStateDestroy(void* ref) {
+  AnimationState* state = ref;
+  lovrRelease(ModelData, state->data);
+  free(state->channels);
+  free(state->cursors);
+  free(state->samples);
+}
+
+ModelData* lovrAnimationStateGetModelData(AnimationState* state) {
+  return state->data;
+}
+
+uint32_t lovrAnimationStateGetAnimation(AnimationState* state) {
+  return state->animation;
+}
+
+float lovrAnimationStateGetDuration(AnimationState* state) {
+  return state->duration;
+}
+
+float lovrAnimationStateGetTime(AnimationState* state) {
+  return state->time;
+}
+
+void lovrAnimationStateSample(AnimationState* state, float time) {
+  time = fmodf(time, state->duration);
+  state->time = time;
+
+  for (uint32_t i = 0; i < state->channelCount; i++) {
+    ModelAnimationChannel* channel = state->channels[i];
+    uint32_t keyframe = findKeyframe(channel, time, &state->cursors[i]);
+    sampleChannel(channel, keyframe, time, state->samples + 4 * i);
   }
 }
 
@@ -126,10 +413,26 @@ Model* lovrModelCreate(ModelData* data) {
     }
 
     model->meshes = calloc(data->primitiveCount, sizeof(Mesh*));
+    model->primitiveBounds = malloc(6 * sizeof(float) * data->primitiveCount);
+    lovrAssert(model->primitiveBounds, "Out of memory");
     for (uint32_t i = 0; i < data->primitiveCount; i++) {
       ModelPrimitive* primitive = &data->primitives[i];
       model->meshes[i] = lovrMeshCreate(primitive->mode, NULL, 0);
 
+      ModelAttribute* position = primitive->attributes[ATTR_POSITION];
+      float* bounds = model->primitiveBounds + 6 * i;
+      if (position && position->hasMin && position->hasMax) {
+        bounds[0] = position->min[0];
+        bounds[1] = position->max[0];
+        bounds[2] = position->min[1];
+        bounds[3] = position->max[1];
+        bounds[4] = position->min[2];
+        bounds[5] = position->max[2];
+      } else {
+        bounds[0] = bounds[2] = bounds[4] = -INFINITY;
+        bounds[1] = bounds[3] = bounds[5] = INFINITY;
+      }
+
       if (primitive->material != ~0u) {
         lovrMeshSetMaterial(model->meshes[i], model->materials[primitive->material]);
       }
@@ -185,11 +488,32 @@ Model* lovrModelCreate(ModelData* data) {
   // Ensure skin bone count doesn't exceed the maximum supported limit
   for (uint32_t i = 0; i < data->skinCount; i++) {
     uint32_t jointCount = data->skins[i].jointCount;
-    lovrAssert(jointCount < MAX_BONES, "ModelData skin '%d' has too many joints (%d, max is %d)", i, jointCount, MAX_BONES);
+    lovrAssert(jointCount <= MAX_BONES, "ModelData skin '%d' has too many joints (%d, max is %d)", i, jointCount, MAX_BONES);
   }
 
-  model->localTransforms = malloc(sizeof(NodeTransform) * data->nodeCount);
+  model->localTransforms[0] = malloc(3 * 4 * sizeof(float) * data->nodeCount);
+  model->localTransforms[1] = model->localTransforms[0] + 4 * data->nodeCount;
+  model->localTransforms[2] = model->localTransforms[1] + 4 * data->nodeCount;
   model->globalTransforms = malloc(16 * sizeof(float) * data->nodeCount);
+  model->nodeBounds = malloc(6 * sizeof(float) * data->nodeCount);
+  model->palettes = data->jointCount > 0 ? malloc(16 * sizeof(float) * data->jointCount) : NULL;
+  model->paletteVersions = calloc(data->skinCount, sizeof(uint32_t));
+  model->nodeOrder = malloc(data->nodeCount * sizeof(uint32_t));
+  model->nodeParents = malloc(data->nodeCount * sizeof(uint32_t));
+  model->dirty = calloc(data->nodeCount, sizeof(uint8_t));
+  model->animations = calloc(data->animationCount, sizeof(AnimationState*));
+
+  // Flatten the hierarchy breadth first, so every node comes after its parent
+  memset(model->nodeParents, 0xff, data->nodeCount * sizeof(uint32_t));
+  model->nodeOrder[model->nodeOrderCount++] = data->rootNode;
+  for (uint32_t i = 0; i < model->nodeOrderCount; i++) {
+    ModelNode* node = &data->nodes[model->nodeOrder[i]];
+    for (uint32_t j = 0; j < node->childCount; j++) {
+      model->nodeParents[node->children[j]] = model->nodeOrder[i];
+      model->nodeOrder[model->nodeOrderCount++] = node->children[j];
+    }
+  }
+
   lovrModelResetPose(model);
   return model;
 }
@@ -225,9 +549,21 @@ void lovrModelDestroy(void* ref) {
     free(model->materials);
   }
 
+  for (uint32_t i = 0; i < model->data->animationCount; i++) {
+    lovrRelease(AnimationState, model->animations[i]);
+  }
+
   lovrRelease(ModelData, model->data);
   free(model->globalTransforms);
-  free(model->localTransforms);
+  free(model->localTransforms[0]);
+  free(model->primitiveBounds);
+  free(model->nodeBounds);
+  free(model->palettes);
+  free(model->paletteVersions);
+  free(model->nodeOrder);
+  free(model->nodeParents);
+  free(model->dirty);
+  free(model->animations);
 }
 
 ModelData* lovrModelGetModelData(Model* model) {
@@ -235,14 +571,15 @@ ModelData* lovrModelGetModelData(Model* model) {
 }
 
 void lovrModelDraw(Model* model, mat4 transform, uint32_t instances) {
-  if (model->transformsDirty) {
-    updateGlobalTransform(model, model->data->rootNode, (float[]) MAT4_IDENTITY);
-    model->transformsDirty = false;
-  }
+  updateTransforms(model);
 
   lovrGraphicsPush();
   lovrGraphicsMatrixTransform(transform);
-  renderNode(model, model->data->rootNode, instances);
+
+  // Instanced draws are positioned by the shader, so they can't be culled on the CPU
+  Frustum frustum;
+  lovrGraphicsGetFrustum(&frustum);
+  renderNode(model, model->data->rootNode, instances, instances <= 1 ? &frustum : NULL);
   lovrGraphicsPop();
 }
 
@@ -252,74 +589,62 @@ void lovrModelAnimate(Model* model, uint32_t animationIndex, float time, float a
   }
 
   lovrAssert(animationIndex < model->data->animationCount, "Invalid animation index '%d' (Model only has %d animations)", animationIndex, model->data->animationCount);
-  ModelAnimation* animation = &model->data->animations[animationIndex];
-  time = fmodf(time, animation->duration);
 
-  for (uint32_t i = 0; i < animation->channelCount; i++) {
-    ModelAnimationChannel* channel = &animation->channels[i];
-    uint32_t nodeIndex = channel->nodeIndex;
-    NodeTransform* transform = &model->localTransforms[nodeIndex];
+  if (!model->animations[animationIndex]) {
+    model->animations[animationIndex] = lovrAnimationStateCreate(model->data, animationIndex);
+  }
 
-    uint32_t keyframe = 0;
-    while (keyframe < channel->keyframeCount && channel->times[keyframe] < time) {
-      keyframe++;
-    }
+  AnimationState* state = model->animations[animationIndex];
+  lovrAnimationStateSample(state, time);
+  lovrModelApplyAnimation(model, state, alpha);
+}
+
+void lovrModelApplyAnimation(Model* model, AnimationState* state, float alpha) {
+  if (alpha <= 0.f) {
+    return;
+  }
 
-    float property[4];
-    bool rotate = channel->property == PROP_ROTATION;
-    size_t n = 3 + rotate;
-    float* (*lerp)(float* a, float* b, float t) = rotate ? quat_slerp : vec3_lerp;
+  lovrAssert(state->data == model->data, "AnimationState was created for a different ModelData");
 
-    if (keyframe == 0 || keyframe >= channel->keyframeCount) {
-      size_t index = CLAMP(keyframe, 0, channel->keyframeCount - 1);
+  // Rotations are sorted before the translations and scales, so each loop only does one kind of
+  // blend.  Partial rotation blends gather chunks of the current rotations onto the stack so they
+  // can be slerped towards the samples in one batch.  The AnimationState is shared by every Model
+  // it gets applied to (possibly on several threads at once), so it can't hold the scratch space.
+  float* rotations = model->localTransforms[PROP_ROTATION];
+  if (alpha >= 1.f) {
+    for (uint32_t i = 0; i < state->rotationCount; i++) {
+      uint32_t nodeIndex = state->channels[i]->nodeIndex;
+      quat_init(rotations + 4 * nodeIndex, state->samples + 4 * i);
+      model->dirty[nodeIndex] = 1;
+    }
+  } else {
+    float blend[4 * BLEND_CHUNK_SIZE];
+    for (uint32_t base = 0; base < state->rotationCount; base += BLEND_CHUNK_SIZE) {
+      uint32_t count = MIN(state->rotationCount - base, BLEND_CHUNK_SIZE);
 
-      // For cubic interpolation, each keyframe has 3 parts, and the actual data is in the middle (*3, +1)
-      if (channel->smoothing == SMOOTH_CUBIC) {
-        index = 3 * index + 1;
+      for (uint32_t i = 0; i < count; i++) {
+        quat_init(blend + 4 * i, rotations + 4 * state->channels[base + i]->nodeIndex);
       }
 
-      memcpy(property, channel->data + index * n, n * sizeof(float));
-    } else {
-      float t1 = channel->times[keyframe - 1];
-      float t2 = channel->times[keyframe];
-      float z = (time - t1) / (t2 - t1);
-
-      switch (channel->smoothing) {
-        case SMOOTH_STEP:
-          memcpy(property, channel->data + (z >= .5f ? keyframe : keyframe - 1) * n, n * sizeof(float));
-          break;
-        case SMOOTH_LINEAR:
-          memcpy(property, channel->data + (keyframe - 1) * n, n * sizeof(float));
-          lerp(property, channel->data + keyframe * n, z);
-          break;
-        case SMOOTH_CUBIC: {
-          size_t stride = 3 * n;
-          float* p0 = channel->data + (keyframe - 1) * stride + 1 * n;
-          float* m0 = channel->data + (keyframe - 1) * stride + 2 * n;
-          float* p1 = channel->data + (keyframe - 0) * stride + 1 * n;
-          float* m1 = channel->data + (keyframe - 0) * stride + 0 * n;
-          float dt = t2 - t1;
-          float z2 = z * z;
-          float z3 = z2 * z;
-          float a = 2.f * z3 - 3.f * z2 + 1.f;
-          float b = 2.f * z3 - 3.f * z2 + 1.f;
-          float c = (-2.f * z3 + 3.f * z2);
-          float d = (z3 * -z2) * dt;
-          for (size_t j = 0; j < n; j++) {
-            property[j] = a * p0[j] + b * m0[j] + c * p1[j] + d * m1[j];
-          }
-          break;
-        }
-        default:
-          break;
+      quat_slerpMany(blend, blend, state->samples + 4 * base, alpha, count);
+
+      for (uint32_t i = 0; i < count; i++) {
+        uint32_t nodeIndex = state->channels[base + i]->nodeIndex;
+        quat_init(rotations + 4 * nodeIndex, blend + 4 * i);
+        model->dirty[nodeIndex] = 1;
       }
     }
+  }
 
-    if (alpha >= 1.f) {
-      memcpy(transform->properties[channel->property], property, n * sizeof(float));
-    } else {
-      lerp(transform->properties[channel->property], property, alpha);
-    }
+  for (uint32_t i = state->rotationCount; i < state->channelCount; i++) {
+    uint32_t nodeIndex = state->channels[i]->nodeIndex;
+    float* transform = model->localTransforms[state->channels[i]->property] + 4 * nodeIndex;
+    float* sample = state->samples + 4 * i;
+    float t = MIN(alpha, 1.f);
+    transform[0] += (sample[0] - transform[0]) * t;
+    transform[1] += (sample[1] - transform[1]) * t;
+    transform[2] += (sample[2] - transform[2]) * t;
+    model->dirty[nodeIndex] = 1;
   }
 
   model->transformsDirty = true;
@@ -328,13 +653,10 @@ void lovrModelAnimate(Model* model, uint32_t animationIndex, float time, float a
 void lovrModelGetNodePose(Model* model, uint32_t nodeIndex, float position[4], float rotation[4], CoordinateSpace space) {
   lovrAssert(nodeIndex < model->data->nodeCount, "Invalid node index '%d' (Model only has %d nodes)", nodeIndex, model->data->nodeCount);
   if (space == SPACE_LOCAL) {
-    vec3_init(position, model->localTransforms[nodeIndex].properties[PROP_TRANSLATION]);
-    quat_init(rotation, model->localTransforms[nodeIndex].properties[PROP_ROTATION]);
+    vec3_init(position, model->localTransforms[PROP_TRANSLATION] + 4 * nodeIndex);
+    quat_init(rotation, model->localTransforms[PROP_ROTATION] + 4 * nodeIndex);
   } else {
-    if (model->transformsDirty) {
-      updateGlobalTransform(model, model->data->rootNode, (float[]) MAT4_IDENTITY);
-      model->transformsDirty = false;
-    }
+    updateTransforms(model);
 
     mat4_getPosition(model->globalTransforms + 16 * nodeIndex, position);
     mat4_getOrientation(model->globalTransforms + 16 * nodeIndex, rotation);
@@ -347,30 +669,37 @@ void lovrModelPose(Model* model, uint32_t nodeIndex, float position[4], float ro
   }
 
   lovrAssert(nodeIndex < model->data->nodeCount, "Invalid node index '%d' (Model only has %d node)", nodeIndex + 1, model->data->nodeCount, model->data->nodeCount == 1 ? "" : "s");
-  NodeTransform* transform = &model->localTransforms[nodeIndex];
+  float* translation = model->localTransforms[PROP_TRANSLATION] + 4 * nodeIndex;
+  float* orientation = model->localTransforms[PROP_ROTATION] + 4 * nodeIndex;
   if (alpha >= 1.f) {
-    vec3_init(transform->properties[PROP_TRANSLATION], position);
-    quat_init(transform->properties[PROP_ROTATION], rotation);
+    vec3_init(translation, position);
+    quat_init(orientation, rotation);
   } else {
-    vec3_lerp(transform->properties[PROP_TRANSLATION], position, alpha);
-    quat_slerp(transform->properties[PROP_ROTATION], rotation, alpha);
+    vec3_lerp(translation, position, alpha);
+    quat_slerp(orientation, rotation, alpha);
   }
+  model->dirty[nodeIndex] = 1;
   model->transformsDirty = true;
 }
 
 void lovrModelResetPose(Model* model) {
   for (uint32_t i = 0; i < model->data->nodeCount; i++) {
+    float* translation = model->localTransforms[PROP_TRANSLATION] + 4 * i;
+    float* rotation = model->localTransforms[PROP_ROTATION] + 4 * i;
+    float* scale = model->localTransforms[PROP_SCALE] + 4 * i;
+
     if (model->data->nodes[i].matrix) {
-      mat4_getPosition(model->data->nodes[i].transform.matrix, model->localTransforms[i].properties[PROP_TRANSLATION]);
-      mat4_getOrientation(model->data->nodes[i].transform.matrix, model->localTransforms[i].properties[PROP_ROTATION]);
-      mat4_getScale(model->data->nodes[i].transform.matrix, model->localTransforms[i].properties[PROP_SCALE]);
+      mat4_getPosition(model->data->nodes[i].transform.matrix, translation);
+      mat4_getOrientation(model->data->nodes[i].transform.matrix, rotation);
+      mat4_getScale(model->data->nodes[i].transform.matrix, scale);
     } else {
-      vec3_init(model->localTransforms[i].properties[PROP_TRANSLATION], model->data->nodes[i].transform.properties.translation);
-      quat_init(model->localTransforms[i].properties[PROP_ROTATION], model->data->nodes[i].transform.properties.rotation);
-      vec3_init(model->localTransforms[i].properties[PROP_SCALE], model->data->nodes[i].transform.properties.scale);
+      vec3_init(translation, model->data->nodes[i].transform.properties.translation);
+      quat_init(rotation, model->data->nodes[i].transform.properties.rotation);
+      vec3_init(scale, model->data->nodes[i].transform.properties.scale);
     }
   }
 
+  memset(model->dirty, 1, model->data->nodeCount * sizeof(uint8_t));
   model->transformsDirty = true;
 }
 
@@ -423,10 +752,7 @@ static void applyAABB(Model* model, uint32_t nodeIndex, float aabb[6]) {
 }
 
 void lovrModelGetAABB(Model* model, float aabb[6]) {
-  if (model->transformsDirty) {
-    updateGlobalTransform(model, model->data->rootNode, (float[]) MAT4_IDENTITY);
-    model->transformsDirty = false;
-  }
+  updateTransforms(model);
 
   aabb[0] = aabb[2] = aabb[4] = FLT_MAX;
   aabb[1] = aabb[3] = aabb[5] = -FLT_MAX;
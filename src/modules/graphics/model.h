@@ -3,6 +3,7 @@
 
 #pragma once
 
+struct AnimationState;
 struct Material;
 struct ModelData;
 
@@ -22,3 +23,13 @@ void lovrModelPose(Model* model, uint32_t nodeIndex, float position[4], float ro
 void lovrModelResetPose(Model* model);
 struct Material* lovrModelGetMaterial(Model* model, uint32_t material);
 void lovrModelGetAABB(Model* model, float aabb[6]);
+void lovrModelApplyAnimation(Model* model, struct AnimationState* state, float alpha);
+
+typedef struct AnimationState AnimationState;
+AnimationState* lovrAnimationStateCreate(struct ModelData* data, uint32_t animationIndex);
+void lovrAnimationStateDestroy(void* ref);
+struct ModelData* lovrAnimationStateGetModelData(AnimationState* state);
+uint32_t lovrAnimationStateGetAnimation(AnimationState* state);
+float lovrAnimationStateGetDuration(AnimationState* state);
+float lovrAnimationStateGetTime(AnimationState* state);
+void lovrAnimationStateSample(AnimationState* state, float time);
@@ -49,6 +49,7 @@ struct Buffer {
   BufferUsage usage;
   bool mapped;
   bool readable;
+  bool persistent;
   uint8_t incoherent;
 };
 
@@ -1484,6 +1485,51 @@ void lovrGpuPresent() {
   state.stats.shaderSwitches = 0;
   state.stats.renderPasses = 0;
   state.stats.drawCalls = 0;
+  state.stats.fenceStalls = 0;
+}
+
+void* lovrGpuFence() {
+#ifdef LOVR_WEBGL
+  return NULL;
+#else
+  state.stats.fenceCount++;
+  return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+}
+
+// Returns whether the GPU has passed the fence.  If block is true, this waits for the fence and
+// counts a stall if it wasn't already signaled.
+bool lovrGpuWait(void* fence, bool block) {
+#ifdef LOVR_WEBGL
+  return true;
+#else
+  if (!fence) {
+    return true;
+  }
+
+  GLenum status = glClientWaitSync(fence, 0, 0);
+  if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED || !block) {
+    return status != GL_TIMEOUT_EXPIRED;
+  }
+
+  state.stats.fenceStalls++;
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  do {
+    status = glClientWaitSync(fence, flags, 1000000000);
+    flags = 0;
+  } while (status == GL_TIMEOUT_EXPIRED);
+
+  return true;
+#endif
+}
+
+void lovrGpuDestroyFence(void* fence) {
+#ifndef LOVR_WEBGL
+  if (fence) {
+    glDeleteSync(fence);
+    state.stats.fenceCount--;
+  }
+#endif
 }
 
 void lovrGpuStencil(StencilAction action, int replaceValue, StencilCallback callback, void* userdata) {
@@ -2199,7 +2245,7 @@ Texture* lovrCanvasGetDepthTexture(Canvas* canvas) {
 
 // Buffer
 
-Buffer* lovrBufferCreate(size_t size, void* data, BufferType type, BufferUsage usage, bool readable) {
+static Buffer* lovrBufferInit(size_t size, void* data, BufferType type, BufferUsage usage, bool readable, bool persistent) {
   Buffer* buffer = lovrAlloc(Buffer);
   state.stats.bufferCount++;
   state.stats.bufferMemory += size;
@@ -2220,12 +2266,29 @@ Buffer* lovrBufferCreate(size_t size, void* data, BufferType type, BufferUsage u
     memcpy(buffer->data, data, size);
   }
 #else
-  glBufferData(glType, size, data, convertBufferUsage(usage));
+  if (persistent && GLAD_GL_ARB_buffer_storage) {
+    glBufferStorage(glType, size, data, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT);
+    buffer->data = glMapBufferRange(glType, 0, size, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+    buffer->mapped = true;
+    buffer->persistent = true;
+  } else {
+    glBufferData(glType, size, data, convertBufferUsage(usage));
+  }
 #endif
 
   return buffer;
 }
 
+Buffer* lovrBufferCreate(size_t size, void* data, BufferType type, BufferUsage usage, bool readable) {
+  return lovrBufferInit(size, data, type, usage, readable, false);
+}
+
+// Persistent Buffers stay mapped for their whole lifetime, so they can only be written to without
+// synchronization.  The caller is responsible for fencing off ranges that the GPU is still using.
+Buffer* lovrBufferCreatePersistent(size_t size, BufferType type) {
+  return lovrBufferInit(size, NULL, type, USAGE_STREAM, false, true);
+}
+
 void lovrBufferDestroy(void* ref) {
   Buffer* buffer = ref;
   lovrGpuDestroySyncResource(buffer, buffer->incoherent);
@@ -2251,6 +2314,7 @@ BufferUsage lovrBufferGetUsage(Buffer* buffer) {
 
 void* lovrBufferMap(Buffer* buffer, size_t offset, bool unsynchronized) {
 #ifndef LOVR_WEBGL
+  lovrAssert(!buffer->persistent || unsynchronized, "Persistent Buffers must be mapped without synchronization");
   if (!buffer->mapped) {
     buffer->mapped = true;
     lovrGpuBindBuffer(buffer->type, buffer->id);
@@ -2280,15 +2344,17 @@ void lovrBufferUnmap(Buffer* buffer) {
     glBufferSubData(convertBufferType(buffer->type), buffer->flushFrom, buffer->flushTo - buffer->flushFrom, data);
   }
 #else
-  if (buffer->mapped) {
+  if (buffer->mapped && (buffer->flushTo > buffer->flushFrom || !buffer->persistent)) {
     lovrGpuBindBuffer(buffer->type, buffer->id);
 
     if (buffer->flushTo > buffer->flushFrom) {
       glFlushMappedBufferRange(convertBufferType(buffer->type), buffer->flushFrom, buffer->flushTo - buffer->flushFrom);
     }
 
-    glUnmapBuffer(convertBufferType(buffer->type));
-    buffer->mapped = false;
+    if (!buffer->persistent) {
+      glUnmapBuffer(convertBufferType(buffer->type));
+      buffer->mapped = false;
+    }
   }
 #endif
   buffer->flushFrom = SIZE_MAX;
@@ -2297,6 +2363,7 @@ void lovrBufferUnmap(Buffer* buffer) {
 
 void lovrBufferDiscard(Buffer* buffer) {
   lovrAssert(!buffer->readable, "Readable Buffers can not be discarded");
+  lovrAssert(!buffer->persistent, "Persistent Buffers can not be discarded");
   lovrAssert(!buffer->mapped, "Mapped Buffers can not be discarded");
   lovrGpuBindBuffer(buffer->type, buffer->id);
   GLenum glType = convertBufferType(buffer->type);
@@ -6,8 +6,16 @@
 #include <stdlib.h>
 #include <math.h>
 
+// The arc length table maps evenly spaced distances along the Curve to curve parameters.  It is
+// rebuilt the next time it's needed after the points change.
+#define ARC_TABLE_SIZE 64
+#define ARC_SAMPLES 256
+
 struct Curve {
   arr_t(float) points;
+  float arcTable[ARC_TABLE_SIZE + 1];
+  float length;
+  bool arcValid;
 };
 
 // Explicit curve evaluation, unroll simple cases to avoid pow overhead
@@ -37,19 +45,105 @@ static void evaluate(float* LOVR_RESTRICT P, size_t n, float t, vec3 p) {
     p[2] = a * P[2] + b * P[6] + c * P[10] + d * P[14];
     p[3] = a * P[3] + b * P[7] + c * P[11] + d * P[15];
   } else {
+    // Horner's rule on the Bernstein form, which avoids pow
+    float s = 1.f - t;
+    float tn = 1.f;
     float b = 1.f;
-    p[0] = p[1] = p[2] = p[3] = 0.f;
-    for (size_t i = 0; i < n; i++, b *= (float) (n - i) / i) {
-      float c1 = powf(1 - t, n - (i + 1));
-      float c2 = powf(t, i);
-      p[0] += b * c1 * c2 * P[i * 4 + 0];
-      p[1] += b * c1 * c2 * P[i * 4 + 1];
-      p[2] += b * c1 * c2 * P[i * 4 + 2];
-      p[3] += b * c1 * c2 * P[i * 4 + 3];
+    size_t degree = n - 1;
+    memcpy(p, P, 4 * sizeof(float));
+    for (size_t i = 1; i <= degree; i++) {
+      tn *= t;
+      b *= (float) (degree - i + 1) / i;
+      p[0] = p[0] * s + b * tn * P[i * 4 + 0];
+      p[1] = p[1] * s + b * tn * P[i * 4 + 1];
+      p[2] = p[2] * s + b * tn * P[i * 4 + 2];
+      p[3] = p[3] * s + b * tn * P[i * 4 + 3];
+    }
+  }
+}
+
+// Curves up to cubic are rendered with forward differencing, which is exact for polynomials up to
+// degree 3.  Differences are kept in doubles so error doesn't build up over long runs of samples.
+static void render(float* P, size_t n, float t1, float t2, float* points, size_t count) {
+  float h = count > 1 ? (t2 - t1) / (count - 1) : 0.f;
+
+  if (n > 4) {
+    for (size_t i = 0; i < count; i++) {
+      float p[4];
+      evaluate(P, n, t1 + h * i, p);
+      memcpy(points + 3 * i, p, 3 * sizeof(float));
+    }
+    return;
+  }
+
+  // Convert to the power basis a + bt + ct^2 + dt^3, then step the differences from t1
+  double p[3], d1[3], d2[3], d3[3];
+  double t = t1, dt = h;
+  for (int c = 0; c < 3; c++) {
+    double P0 = P[c], P1 = P[4 + c], a = P0, b, q = 0., d = 0.;
+    if (n == 2) {
+      b = P1 - P0;
+    } else if (n == 3) {
+      double P2 = P[8 + c];
+      b = 2. * (P1 - P0);
+      q = P0 - 2. * P1 + P2;
+    } else {
+      double P2 = P[8 + c], P3 = P[12 + c];
+      b = 3. * (P1 - P0);
+      q = 3. * (P0 - 2. * P1 + P2);
+      d = -P0 + 3. * P1 - 3. * P2 + P3;
+    }
+
+    p[c] = a + t * (b + t * (q + t * d));
+    d1[c] = b * dt + q * (2. * t * dt + dt * dt) + d * (3. * t * t * dt + 3. * t * dt * dt + dt * dt * dt);
+    d2[c] = 2. * q * dt * dt + d * (6. * t * dt * dt + 6. * dt * dt * dt);
+    d3[c] = 6. * d * dt * dt * dt;
+  }
+
+  for (size_t i = 0; i < count; i++, points += 3) {
+    for (int c = 0; c < 3; c++) {
+      points[c] = (float) p[c];
+      p[c] += d1[c];
+      d1[c] += d2[c];
+      d2[c] += d3[c];
     }
   }
 }
 
+static void updateArcTable(Curve* curve) {
+  if (curve->arcValid) {
+    return;
+  }
+
+  float samples[3 * (ARC_SAMPLES + 1)];
+  float distances[ARC_SAMPLES + 1];
+  render(curve->points.data, curve->points.length / 4, 0.f, 1.f, samples, ARC_SAMPLES + 1);
+
+  distances[0] = 0.f;
+  for (size_t i = 1; i <= ARC_SAMPLES; i++) {
+    float* a = samples + 3 * (i - 1);
+    float* b = samples + 3 * i;
+    float dx = b[0] - a[0], dy = b[1] - a[1], dz = b[2] - a[2];
+    distances[i] = distances[i - 1] + sqrtf(dx * dx + dy * dy + dz * dz);
+  }
+
+  curve->length = distances[ARC_SAMPLES];
+
+  // Walk the samples once, interpolating the parameter for each evenly spaced distance
+  size_t j = 0;
+  for (size_t i = 0; i <= ARC_TABLE_SIZE; i++) {
+    float target = curve->length * i / ARC_TABLE_SIZE;
+    while (j < ARC_SAMPLES - 1 && distances[j + 1] < target) {
+      j++;
+    }
+    float span = distances[j + 1] - distances[j];
+    float f = span > 0.f ? CLAMP((target - distances[j]) / span, 0.f, 1.f) : 0.f;
+    curve->arcTable[i] = (j + f) / ARC_SAMPLES;
+  }
+
+  curve->arcValid = true;
+}
+
 Curve* lovrCurveCreate(void) {
   Curve* curve = lovrAlloc(Curve);
   arr_init(&curve->points);
@@ -77,6 +171,42 @@ void lovrCurveGetTangent(Curve* curve, float t, vec3 p) {
   vec3_normalize(p);
 }
 
+// Writes count evenly spaced points between t1 and t2, 3 floats each.  When uniform is set, t1 and
+// t2 are fractions of the Curve's length and the points are evenly spaced along the Curve.
+void lovrCurveRender(Curve* curve, float t1, float t2, float* points, size_t count, bool uniform) {
+  lovrAssert(curve->points.length >= 8, "Need at least 2 points to render a Curve");
+  lovrAssert(t1 >= 0.f && t2 <= 1.f, "Curve render interval must be within [0, 1]");
+  size_t n = curve->points.length / 4;
+
+  if (!uniform) {
+    render(curve->points.data, n, t1, t2, points, count);
+    return;
+  }
+
+  float h = count > 1 ? (t2 - t1) / (count - 1) : 0.f;
+  for (size_t i = 0; i < count; i++) {
+    float p[4];
+    evaluate(curve->points.data, n, lovrCurveGetUniformParameter(curve, t1 + h * i), p);
+    memcpy(points + 3 * i, p, 3 * sizeof(float));
+  }
+}
+
+float lovrCurveGetLength(Curve* curve) {
+  lovrAssert(curve->points.length >= 8, "Need at least 2 points to measure a Curve");
+  updateArcTable(curve);
+  return curve->length;
+}
+
+// Converts a fraction of the Curve's length to the curve parameter at that distance
+float lovrCurveGetUniformParameter(Curve* curve, float u) {
+  lovrAssert(curve->points.length >= 8, "Need at least 2 points to measure a Curve");
+  updateArcTable(curve);
+  float x = CLAMP(u, 0.f, 1.f) * ARC_TABLE_SIZE;
+  size_t i = MIN((size_t) x, ARC_TABLE_SIZE - 1);
+  float f = x - i;
+  return curve->arcTable[i] + (curve->arcTable[i + 1] - curve->arcTable[i]) * f;
+}
+
 Curve* lovrCurveSlice(Curve* curve, float t1, float t2) {
   lovrAssert(curve->points.length >= 8, "Need at least 2 points to slice a Curve");
   lovrAssert(t1 >= 0.f && t2 <= 1.f, "Curve slice interval must be within [0, 1]");
@@ -113,6 +243,7 @@ void lovrCurveGetPoint(Curve* curve, size_t index, vec3 point) {
 
 void lovrCurveSetPoint(Curve* curve, size_t index, vec3 point) {
   vec3_init(curve->points.data + 4 * index, point);
+  curve->arcValid = false;
 }
 
 void lovrCurveAddPoint(Curve* curve, vec3 point, size_t index) {
@@ -129,8 +260,10 @@ void lovrCurveAddPoint(Curve* curve, vec3 point, size_t index) {
   // Fill the empty space with the new point
   curve->points.length += 4;
   memcpy(dest, point, 4 * sizeof(float));
+  curve->arcValid = false;
 }
 
 void lovrCurveRemovePoint(Curve* curve, size_t index) {
   arr_splice(&curve->points, index * 4, 4);
+  curve->arcValid = false;
 }
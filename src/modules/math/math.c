@@ -1,5 +1,6 @@
 #include "math.h"
 #include "math/randomGenerator.h"
+#include "core/job.h"
 #include "core/maf.h"
 #include "core/ref.h"
 #include "core/util.h"
@@ -9,6 +10,23 @@
 #include <stdlib.h>
 #include <time.h>
 
+// Arrays bigger than one chunk are split into chunks, which run on the job workers
+#define ARRAY_CHUNK_SIZE 16384
+
+// Past this many octaves the frequencies are too high for float coordinates to mean anything
+#define MAX_NOISE_OCTAVES 32
+
+typedef struct {
+  float* a;
+  const float* b;
+  float* out;
+  float* transform;
+  size_t count;
+  size_t components;
+  ArrayOp op;
+  float t;
+} ArrayBatch;
+
 static struct {
   bool initialized;
   RandomGenerator* generator;
@@ -63,3 +81,266 @@ float lovrMathNoise3(float x, float y, float z) {
 float lovrMathNoise4(float x, float y, float z, float w) {
   return noise4(x, y, z, w) * .5f + .5f;
 }
+
+typedef struct {
+  float* data;
+  uint32_t width;
+  uint32_t height;
+  float scale;
+  NoiseInfo* info;
+} NoiseBatch;
+
+// Each job fills one row.  The octaves are scaled by the sum of their amplitudes, so the result
+// stays between 0 and 1.
+static void fillNoiseRow(void* context, uint32_t index) {
+  NoiseBatch* batch = context;
+  NoiseInfo* info = batch->info;
+  uint32_t y = index % batch->height;
+  uint32_t z = index / batch->height;
+  float* row = batch->data + (size_t) index * batch->width;
+  float py = info->origin[1] + y * info->spacing[1];
+  float pz = info->origin[2] + z * info->spacing[2];
+
+  for (uint32_t x = 0; x < batch->width; x++) {
+    float px = info->origin[0] + x * info->spacing[0];
+    float frequency = 1.f;
+    float sum = 0.f;
+    float amplitude = 1.f;
+    for (uint32_t o = 0; o < info->octaves; o++) {
+      if (info->dimensions == 3) {
+        sum += amplitude * noise3(px * frequency, py * frequency, pz * frequency);
+      } else {
+        sum += amplitude * noise2(px * frequency, py * frequency);
+      }
+      frequency *= info->lacunarity;
+      amplitude *= info->gain;
+    }
+    row[x] = sum * batch->scale + .5f;
+  }
+}
+
+// Samples are written with x changing fastest, then y, then z
+void lovrMathFillNoise(float* data, uint32_t width, uint32_t height, uint32_t depth, NoiseInfo* info) {
+  lovrAssert(info->dimensions == 2 || info->dimensions == 3, "Noise grids must be 2D or 3D");
+  lovrAssert(info->octaves >= 1 && info->octaves <= MAX_NOISE_OCTAVES, "Noise needs between 1 and %d octaves", MAX_NOISE_OCTAVES);
+  lovrAssert(info->lacunarity > 0.f && isfinite(info->lacunarity), "Noise lacunarity must be positive");
+  lovrAssert(info->gain > 0.f, "Noise gain must be positive");
+  for (int i = 0; i < 3; i++) {
+    lovrAssert(isfinite(info->origin[i]) && isfinite(info->spacing[i]), "Noise origin and spacing must be finite");
+  }
+
+  float total = 0.f;
+  float amplitude = 1.f;
+  for (uint32_t o = 0; o < info->octaves; o++) {
+    total += amplitude;
+    amplitude *= info->gain;
+  }
+  lovrAssert(isfinite(total), "Noise gain is too large for %d octaves", info->octaves);
+
+  NoiseBatch batch = { data, width, height, .5f / total, info };
+  JobCounter counter = { 0 };
+  job_run(fillNoiseRow, &batch, height * depth, &counter, NULL);
+  job_wait(&counter);
+}
+
+static size_t getChunkCount(size_t count) {
+  return (count + ARRAY_CHUNK_SIZE - 1) / ARRAY_CHUNK_SIZE;
+}
+
+static void runArray(jobFn* fn, ArrayBatch* batch) {
+  size_t chunks = getChunkCount(batch->count);
+  if (chunks <= 1 || job_getWorkerCount() == 0) {
+    for (size_t i = 0; i < chunks; i++) {
+      fn(batch, i);
+    }
+    return;
+  }
+
+  JobCounter counter = { 0 };
+  job_run(fn, batch, chunks, &counter, NULL);
+  job_wait(&counter);
+}
+
+// Returns the range of vectors in a chunk
+static size_t getChunk(ArrayBatch* batch, uint32_t index, size_t* start) {
+  *start = (size_t) index * ARRAY_CHUNK_SIZE;
+  return MIN(batch->count - *start, ARRAY_CHUNK_SIZE);
+}
+
+static void transformChunk(void* context, uint32_t index) {
+  ArrayBatch* batch = context;
+  size_t start, count = getChunk(batch, index, &start);
+  mat4_transformPoints(batch->transform, batch->a + start * batch->components, count, batch->components);
+}
+
+static void normalizeChunk(void* context, uint32_t index) {
+  ArrayBatch* batch = context;
+  size_t start, count = getChunk(batch, index, &start);
+  size_t n = batch->components;
+  float* v = batch->a + start * n;
+  for (size_t i = 0; i < count; i++, v += n) {
+    float length2 = 0.f;
+    for (size_t c = 0; c < n; c++) {
+      length2 += v[c] * v[c];
+    }
+    if (length2 > 0.f) {
+      float scale = 1.f / sqrtf(length2);
+      for (size_t c = 0; c < n; c++) {
+        v[c] *= scale;
+      }
+    }
+  }
+}
+
+// Components don't matter for elementwise ops, so the arrays are treated as flat lists of floats
+static void combineChunk(void* context, uint32_t index) {
+  ArrayBatch* batch = context;
+  size_t start, count = getChunk(batch, index, &start);
+  float* a = batch->a + start * batch->components;
+  const float* b = batch->b + start * batch->components;
+  size_t n = count * batch->components;
+  size_t i = 0;
+
+#ifdef MAF_SIMD
+  if (batch->op == ARRAY_LERP) {
+    maf_f4 t = maf_splat(batch->t);
+    maf_f4 s = maf_splat(1.f - batch->t);
+    for (; i + 4 <= n; i += 4) {
+      maf_store(a + i, maf_madd(maf_load(b + i), t, maf_mul(maf_load(a + i), s)));
+    }
+  }
+#endif
+
+  switch (batch->op) {
+    case ARRAY_LERP: for (; i < n; i++) a[i] = a[i] * (1.f - batch->t) + b[i] * batch->t; break;
+    case ARRAY_MIN: for (; i < n; i++) a[i] = MIN(a[i], b[i]); break;
+    case ARRAY_MAX: for (; i < n; i++) a[i] = MAX(a[i], b[i]); break;
+    default: break;
+  }
+}
+
+static void dotChunk(void* context, uint32_t index) {
+  ArrayBatch* batch = context;
+  size_t start, count = getChunk(batch, index, &start);
+  size_t n = batch->components;
+  const float* a = batch->a + start * n;
+  const float* b = batch->b + start * n;
+  float* dots = batch->out + start;
+  for (size_t i = 0; i < count; i++, a += n, b += n) {
+    float dot = 0.f;
+    for (size_t c = 0; c < n; c++) {
+      dot += a[c] * b[c];
+    }
+    dots[i] = dot;
+  }
+}
+
+static void crossChunk(void* context, uint32_t index) {
+  ArrayBatch* batch = context;
+  size_t start, count = getChunk(batch, index, &start);
+  size_t n = batch->components;
+  float* a = batch->a + start * n;
+  const float* b = batch->b + start * n;
+  for (size_t i = 0; i < count; i++, a += n, b += n) {
+    float x = a[1] * b[2] - a[2] * b[1];
+    float y = a[2] * b[0] - a[0] * b[2];
+    float z = a[0] * b[1] - a[1] * b[0];
+    a[0] = x;
+    a[1] = y;
+    a[2] = z;
+  }
+}
+
+// Reductions write one partial result per chunk to out, which are combined afterwards
+static void sumChunk(void* context, uint32_t index) {
+  ArrayBatch* batch = context;
+  size_t start, count = getChunk(batch, index, &start);
+  size_t n = batch->components;
+  const float* v = batch->b + start * n;
+  float* sum = batch->out + index * n;
+  for (size_t c = 0; c < n; c++) {
+    sum[c] = 0.f;
+  }
+  for (size_t i = 0; i < count; i++, v += n) {
+    for (size_t c = 0; c < n; c++) {
+      sum[c] += v[c];
+    }
+  }
+}
+
+static void boundsChunk(void* context, uint32_t index) {
+  ArrayBatch* batch = context;
+  size_t start, count = getChunk(batch, index, &start);
+  size_t n = batch->components;
+  const float* p = batch->b + start * n;
+  float* aabb = batch->out + index * 6;
+  aabb[0] = aabb[2] = aabb[4] = HUGE_VALF;
+  aabb[1] = aabb[3] = aabb[5] = -HUGE_VALF;
+  for (size_t i = 0; i < count; i++, p += n) {
+    for (size_t c = 0; c < 3; c++) {
+      aabb[2 * c + 0] = MIN(aabb[2 * c + 0], p[c]);
+      aabb[2 * c + 1] = MAX(aabb[2 * c + 1], p[c]);
+    }
+  }
+}
+
+void lovrMathTransformArray(float* points, size_t count, size_t components, float* transform) {
+  lovrAssert(components >= 3, "Points need at least 3 components to be transformed");
+  runArray(transformChunk, &(ArrayBatch) { .a = points, .count = count, .components = components, .transform = transform });
+}
+
+void lovrMathNormalizeArray(float* vectors, size_t count, size_t components) {
+  runArray(normalizeChunk, &(ArrayBatch) { .a = vectors, .count = count, .components = components });
+}
+
+void lovrMathCombineArrays(float* a, const float* b, size_t count, size_t components, ArrayOp op, float t) {
+  runArray(combineChunk, &(ArrayBatch) { .a = a, .b = b, .count = count, .components = components, .op = op, .t = t });
+}
+
+void lovrMathDotArrays(float* dots, const float* a, const float* b, size_t count, size_t components) {
+  runArray(dotChunk, &(ArrayBatch) { .a = (float*) a, .b = b, .out = dots, .count = count, .components = components });
+}
+
+void lovrMathCrossArrays(float* a, const float* b, size_t count, size_t components) {
+  lovrAssert(components >= 3, "Cross products need at least 3 components");
+  runArray(crossChunk, &(ArrayBatch) { .a = a, .b = b, .count = count, .components = components });
+}
+
+void lovrMathSumArray(const float* vectors, size_t count, size_t components, float* sum) {
+  size_t chunks = getChunkCount(count);
+  float* partials = malloc(MAX(chunks, 1) * components * sizeof(float));
+  lovrAssert(partials, "Out of memory");
+  runArray(sumChunk, &(ArrayBatch) { .b = vectors, .out = partials, .count = count, .components = components });
+
+  for (size_t c = 0; c < components; c++) {
+    sum[c] = 0.f;
+  }
+
+  for (size_t i = 0; i < chunks; i++) {
+    for (size_t c = 0; c < components; c++) {
+      sum[c] += partials[i * components + c];
+    }
+  }
+
+  free(partials);
+}
+
+// Bounds use the same order as the other AABBs: minx, maxx, miny, maxy, minz, maxz
+void lovrMathGetArrayBounds(const float* points, size_t count, size_t components, float aabb[6]) {
+  lovrAssert(components >= 3, "Points need at least 3 components to compute bounds");
+  size_t chunks = getChunkCount(count);
+  float* partials = malloc(MAX(chunks, 1) * 6 * sizeof(float));
+  lovrAssert(partials, "Out of memory");
+  runArray(boundsChunk, &(ArrayBatch) { .b = points, .out = partials, .count = count, .components = components });
+
+  aabb[0] = aabb[2] = aabb[4] = count > 0 ? HUGE_VALF : 0.f;
+  aabb[1] = aabb[3] = aabb[5] = count > 0 ? -HUGE_VALF : 0.f;
+  for (size_t i = 0; i < chunks; i++) {
+    for (size_t c = 0; c < 6; c += 2) {
+      aabb[c + 0] = MIN(aabb[c + 0], partials[i * 6 + c + 0]);
+      aabb[c + 1] = MAX(aabb[c + 1], partials[i * 6 + c + 1]);
+    }
+  }
+
+  free(partials);
+}
@@ -1,7 +1,26 @@
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #pragma once
 
+typedef enum {
+  ARRAY_LERP,
+  ARRAY_MIN,
+  ARRAY_MAX
+} ArrayOp;
+
+// Fractal noise over a grid of samples, each octave adds noise with a higher frequency (scaled by
+// the lacunarity) and a lower amplitude (scaled by the gain)
+typedef struct {
+  uint32_t dimensions;
+  float origin[3];
+  float spacing[3];
+  uint32_t octaves;
+  float lacunarity;
+  float gain;
+} NoiseInfo;
+
 struct RandomGenerator;
 bool lovrMathInit(void);
 void lovrMathDestroy(void);
@@ -13,3 +32,13 @@ float lovrMathNoise1(float x);
 float lovrMathNoise2(float x, float y);
 float lovrMathNoise3(float x, float y, float z);
 float lovrMathNoise4(float x, float y, float z, float w);
+void lovrMathFillNoise(float* data, uint32_t width, uint32_t height, uint32_t depth, NoiseInfo* info);
+
+// Array functions work on tightly packed arrays of count vectors with the given number of components
+void lovrMathTransformArray(float* points, size_t count, size_t components, float* transform);
+void lovrMathNormalizeArray(float* vectors, size_t count, size_t components);
+void lovrMathCombineArrays(float* a, const float* b, size_t count, size_t components, ArrayOp op, float t);
+void lovrMathDotArrays(float* dots, const float* a, const float* b, size_t count, size_t components);
+void lovrMathCrossArrays(float* a, const float* b, size_t count, size_t components);
+void lovrMathSumArray(const float* vectors, size_t count, size_t components, float* sum);
+void lovrMathGetArrayBounds(const float* points, size_t count, size_t components, float aabb[6]);
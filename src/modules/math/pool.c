@@ -2,6 +2,8 @@
 #include "core/util.h"
 #include <stdlib.h>
 
+#define END_OF_LIST ~0u
+
 static const size_t vectorComponents[] = {
   [V_VEC2] = 2,
   [V_VEC3] = 4,
@@ -10,18 +12,28 @@ static const size_t vectorComponents[] = {
   [V_MAT4] = 16
 };
 
-Pool* lovrPoolInit(Pool* pool) {
-  lovrPoolGrow(pool, 1 << 12);
+// The limit is the most floats the temporary pool is allowed to grow to
+Pool* lovrPoolInit(Pool* pool, size_t limit) {
+  pool->limit = MIN(limit, MAX_POOL_SIZE);
+  lovrPoolGrow(pool, MIN(1 << 12, pool->limit));
+  for (size_t i = 0; i < MAX_VECTOR_TYPES; i++) {
+    pool->slabs[i].freeList = END_OF_LIST;
+  }
   return pool;
 }
 
 void lovrPoolDestroy(void* ref) {
   Pool* pool = ref;
   free(pool->data);
+  for (size_t i = 0; i < MAX_VECTOR_TYPES; i++) {
+    free(pool->slabs[i].data);
+    free(pool->slabs[i].generations);
+    free(pool->slabs[i].next);
+  }
 }
 
 void lovrPoolGrow(Pool* pool, size_t count) {
-  lovrAssert(count <= (1 << 16), "Temporary vector space exhausted.  Try using lovr.math.drain to drain the vector pool periodically.");
+  lovrAssert(count <= pool->limit, "Temporary vector space exhausted.  Try using lovr.math.drain to drain the vector pool periodically, or increase t.math.poolsize.");
   pool->count = count;
   pool->data = realloc(pool->data, pool->count * sizeof(float));
   lovrAssert(pool->data, "Out of memory");
@@ -31,23 +43,70 @@ Vector lovrPoolAllocate(Pool* pool, VectorType type, float** data) {
   size_t count = vectorComponents[type];
 
   if (pool->cursor + count > pool->count) {
-    lovrPoolGrow(pool, pool->count * 2);
+    lovrPoolGrow(pool, MIN(pool->count * 2, pool->limit));
+    lovrAssert(pool->cursor + count <= pool->count, "Temporary vector space exhausted.  Try using lovr.math.drain to drain the vector pool periodically, or increase t.math.poolsize.");
   }
 
-  Vector v = {
-    .handle = {
-      .type = type,
-      .generation = (uint8_t) pool->generation,
-      .index = (uint16_t) pool->cursor
-    }
-  };
+  Vector v = { .pointer = NULL };
+  v.handle.type = type;
+  v.handle.generation = pool->generation;
+  v.handle.index = pool->cursor;
 
   *data = pool->data + pool->cursor;
   pool->cursor += count;
   return v;
 }
 
+Vector lovrPoolAllocatePersistent(Pool* pool, VectorType type, float** data) {
+  Slab* slab = &pool->slabs[type];
+  size_t components = vectorComponents[type];
+  uint32_t index;
+
+  if (slab->freeList != END_OF_LIST) {
+    index = slab->freeList;
+    slab->freeList = slab->next[index];
+  } else {
+    if (slab->count >= slab->capacity) {
+      lovrAssert(slab->capacity < MAX_POOL_SIZE, "Too many persistent vectors");
+      slab->capacity = slab->capacity ? slab->capacity * 2 : 64;
+      slab->data = realloc(slab->data, slab->capacity * components * sizeof(float));
+      slab->generations = realloc(slab->generations, slab->capacity * sizeof(uint8_t));
+      slab->next = realloc(slab->next, slab->capacity * sizeof(uint32_t));
+      lovrAssert(slab->data && slab->generations && slab->next, "Out of memory");
+    }
+
+    index = slab->count++;
+    slab->generations[index] = 0;
+  }
+
+  Vector v = { .pointer = NULL };
+  v.handle.type = type;
+  v.handle.persistent = true;
+  v.handle.generation = slab->generations[index];
+  v.handle.index = index;
+
+  *data = slab->data + index * components;
+  return v;
+}
+
+// Freeing a slot bumps its generation, so any handles that are left over stop resolving
+void lovrPoolFree(Pool* pool, Vector vector) {
+  lovrAssert(vector.handle.persistent, "Only persistent vectors can be freed");
+  lovrPoolResolve(pool, vector);
+  Slab* slab = &pool->slabs[vector.handle.type];
+  uint32_t index = vector.handle.index;
+  slab->generations[index]++;
+  slab->next[index] = slab->freeList;
+  slab->freeList = index;
+}
+
 float* lovrPoolResolve(Pool* pool, Vector vector) {
+  if (vector.handle.persistent) {
+    Slab* slab = &pool->slabs[vector.handle.type];
+    lovrAssert(vector.handle.index < slab->count && vector.handle.generation == slab->generations[vector.handle.index], "Attempt to use a persistent vector after it was freed");
+    return slab->data + vector.handle.index * vectorComponents[vector.handle.type];
+  }
+
   lovrAssert(vector.handle.generation == pool->generation, "Attempt to use a vector in a different generation than the one it was created in (vectors can not be saved into variables)");
   return pool->data + vector.handle.index;
 }
@@ -1,8 +1,11 @@
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
 #pragma once
 
+#define MAX_POOL_SIZE (1 << 20)
+
 typedef enum {
   V_NONE,
   V_VEC2,
@@ -13,27 +16,43 @@ typedef enum {
   MAX_VECTOR_TYPES
 } VectorType;
 
+// Handles fit in 32 bits so they can be stored in a lightuserdata on every platform.  Temporary
+// handles use the generation of the whole pool, persistent handles use the generation of their slot.
 typedef union {
   void* pointer;
   struct {
-    uint8_t type;
-    uint8_t generation;
-    uint16_t index;
-    uint32_t padding;
+    uint32_t type : 3;
+    uint32_t persistent : 1;
+    uint32_t generation : 8;
+    uint32_t index : 20;
   } handle;
 } Vector;
 
+// Persistent vectors of one type live in a slab of fixed size slots, and freed slots are reused
+typedef struct {
+  float* data;
+  uint8_t* generations;
+  uint32_t* next;
+  uint32_t count;
+  uint32_t capacity;
+  uint32_t freeList;
+} Slab;
+
 typedef struct Pool {
   float* data;
   size_t count;
   size_t cursor;
+  size_t limit;
   size_t generation;
+  Slab slabs[MAX_VECTOR_TYPES];
 } Pool;
 
-Pool* lovrPoolInit(Pool* pool);
-#define lovrPoolCreate(...) lovrPoolInit(lovrAlloc(Pool))
+Pool* lovrPoolInit(Pool* pool, size_t limit);
+#define lovrPoolCreate(...) lovrPoolInit(lovrAlloc(Pool), __VA_ARGS__)
 void lovrPoolDestroy(void* ref);
 void lovrPoolGrow(Pool* pool, size_t count);
 Vector lovrPoolAllocate(Pool* pool, VectorType type, float** data);
+Vector lovrPoolAllocatePersistent(Pool* pool, VectorType type, float** data);
+void lovrPoolFree(Pool* pool, Vector vector);
 float* lovrPoolResolve(Pool* pool, Vector vector);
 void lovrPoolDrain(Pool* pool);
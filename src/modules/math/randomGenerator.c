@@ -1,11 +1,16 @@
 #include "math/randomGenerator.h"
+#include "core/job.h"
 #include "core/ref.h"
 #include "core/util.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 
+// Bulk fills are split into chunks of samples, and each chunk has its own xoshiro256** stream
+#define RANDOM_CHUNK_SIZE 4096
+
 struct RandomGenerator {
   Seed seed;
   Seed state;
@@ -95,3 +100,144 @@ double lovrRandomGeneratorRandomNormal(RandomGenerator* generator) {
   generator->lastRandomNormal = r * cos(phi);
   return r * sin(phi);
 }
+
+// xoshiro256** and its jump function, from http://prng.di.unimi.it (public domain)
+static uint64_t rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t xoshiro256(uint64_t s[4]) {
+  uint64_t result = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return result;
+}
+
+// Equivalent to 2^128 calls to xoshiro256, so streams that are a jump apart never overlap
+static void xoshiro256Jump(uint64_t s[4]) {
+  static const uint64_t jump[] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+  uint64_t t[4] = { 0 };
+  for (int i = 0; i < 4; i++) {
+    for (int b = 0; b < 64; b++) {
+      if (jump[i] & (1ULL << b)) {
+        t[0] ^= s[0];
+        t[1] ^= s[1];
+        t[2] ^= s[2];
+        t[3] ^= s[3];
+      }
+      xoshiro256(s);
+    }
+  }
+  s[0] = t[0];
+  s[1] = t[1];
+  s[2] = t[2];
+  s[3] = t[3];
+}
+
+// Uniform float in [0, 1), using the top 24 bits
+static float randomFloat(uint64_t s[4]) {
+  return (xoshiro256(s) >> 40) * (1.f / 16777216.f);
+}
+
+typedef struct {
+  uint64_t (*streams)[4];
+  float* data;
+  size_t count;
+  RandomDistribution distribution;
+} RandomBatch;
+
+static void fillChunk(void* context, uint32_t index) {
+  RandomBatch* batch = context;
+  uint64_t* s = batch->streams[index];
+  size_t start = (size_t) index * RANDOM_CHUNK_SIZE;
+  size_t count = MIN(batch->count - start, RANDOM_CHUNK_SIZE);
+
+  switch (batch->distribution) {
+    case RANDOM_UNIFORM: {
+      float* data = batch->data + start;
+      for (size_t i = 0; i < count; i++) {
+        data[i] = randomFloat(s);
+      }
+      break;
+    }
+
+    case RANDOM_NORMAL: {
+      float* data = batch->data + start;
+      for (size_t i = 0; i < count; i += 2) {
+        float r = sqrtf(-2.f * logf(1.f - randomFloat(s)));
+        float phi = 2.f * (float) M_PI * randomFloat(s);
+        data[i] = r * cosf(phi);
+        if (i + 1 < count) {
+          data[i + 1] = r * sinf(phi);
+        }
+      }
+      break;
+    }
+
+    case RANDOM_IN_SPHERE: {
+      float* data = batch->data + 3 * start;
+      for (size_t i = 0; i < count; i++, data += 3) {
+        float x, y, z;
+        do {
+          x = randomFloat(s) * 2.f - 1.f;
+          y = randomFloat(s) * 2.f - 1.f;
+          z = randomFloat(s) * 2.f - 1.f;
+        } while (x * x + y * y + z * z > 1.f);
+        data[0] = x;
+        data[1] = y;
+        data[2] = z;
+      }
+      break;
+    }
+
+    case RANDOM_ON_SPHERE: {
+      float* data = batch->data + 3 * start;
+      for (size_t i = 0; i < count; i++, data += 3) {
+        float z = randomFloat(s) * 2.f - 1.f;
+        float phi = 2.f * (float) M_PI * randomFloat(s);
+        float r = sqrtf(1.f - z * z);
+        data[0] = r * cosf(phi);
+        data[1] = r * sinf(phi);
+        data[2] = z;
+      }
+      break;
+    }
+  }
+}
+
+// Fills count samples (sphere samples are 3 floats).  The streams only depend on the generator's
+// state, so results are the same no matter how many job workers there are.  The generator moves
+// forward by one number, so the next fill is different.
+void lovrRandomGeneratorFill(RandomGenerator* generator, float* data, size_t count, RandomDistribution distribution) {
+  size_t chunks = (count + RANDOM_CHUNK_SIZE - 1) / RANDOM_CHUNK_SIZE;
+  if (chunks == 0) {
+    return;
+  }
+
+  RandomBatch batch = { malloc(chunks * sizeof(*batch.streams)), data, count, distribution };
+  lovrAssert(batch.streams, "Out of memory");
+
+  // Seed the first stream with splitmix64 (also from http://prng.di.unimi.it)
+  uint64_t x = (uint64_t) (lovrRandomGeneratorRandom(generator) * 9007199254740992.) ^ generator->state.b64;
+  for (int i = 0; i < 4; i++) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    batch.streams[0][i] = z ^ (z >> 31);
+  }
+
+  for (size_t i = 1; i < chunks; i++) {
+    memcpy(batch.streams[i], batch.streams[i - 1], sizeof(batch.streams[i]));
+    xoshiro256Jump(batch.streams[i]);
+  }
+
+  JobCounter counter = { 0 };
+  job_run(fillChunk, &batch, chunks, &counter, NULL);
+  job_wait(&counter);
+  free(batch.streams);
+}
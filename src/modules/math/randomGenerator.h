@@ -13,6 +13,13 @@ typedef union {
   } b32;
 } Seed;
 
+typedef enum {
+  RANDOM_UNIFORM,
+  RANDOM_NORMAL,
+  RANDOM_IN_SPHERE,
+  RANDOM_ON_SPHERE
+} RandomDistribution;
+
 typedef struct RandomGenerator RandomGenerator;
 RandomGenerator* lovrRandomGeneratorCreate(void);
 void lovrRandomGeneratorDestroy(void* ref);
@@ -22,3 +29,4 @@ void lovrRandomGeneratorGetState(RandomGenerator* generator, char* state, size_t
 int lovrRandomGeneratorSetState(RandomGenerator* generator, const char* state);
 double lovrRandomGeneratorRandom(RandomGenerator* generator);
 double lovrRandomGeneratorRandomNormal(RandomGenerator* generator);
+void lovrRandomGeneratorFill(RandomGenerator* generator, float* data, size_t count, RandomDistribution distribution);
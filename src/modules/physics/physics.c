@@ -1,20 +1,107 @@
 #include "physics.h"
+#include "data/blob.h"
+#include "core/job.h"
+#include "core/map.h"
+#include "core/os.h"
 #include "core/ref.h"
 #include "core/util.h"
 #include <stdlib.h>
 #include <stdbool.h>
 
+#define QUERY_CHUNK_SIZE 64
+#define MAX_SWEEP_STEPS 256
+#define MAX_WORKERS 16
+#define SWEEP_REFINEMENT 6
+#define NO_TAG_BIT (1 << MAX_TAGS)
+
+// With tag spaces, the broadphase can also hand over pairs of spaces, which get expanded here
 static void defaultNearCallback(void* data, dGeomID a, dGeomID b) {
+  if (dGeomIsSpace(a) || dGeomIsSpace(b)) {
+    dSpaceCollide2(a, b, data, defaultNearCallback);
+    return;
+  }
+
   lovrWorldCollide((World*) data, dGeomGetData(a), dGeomGetData(b), -1, -1);
 }
 
 static void customNearCallback(void* data, dGeomID shapeA, dGeomID shapeB) {
+  if (dGeomIsSpace(shapeA) || dGeomIsSpace(shapeB)) {
+    dSpaceCollide2(shapeA, shapeB, data, customNearCallback);
+    return;
+  }
+
   World* world = data;
   arr_push(&world->overlaps, dGeomGetData(shapeA));
   arr_push(&world->overlaps, dGeomGetData(shapeB));
 }
 
+static bool isMasked(World* world, Collider* a, Collider* b) {
+  uint32_t i = a->tag;
+  uint32_t j = b->tag;
+  return i != NO_TAG && j != NO_TAG && !((world->masks[i] & (1 << j)) && (world->masks[j] & (1 << i)));
+}
+
+static void contactNearCallback(void* data, dGeomID a, dGeomID b) {
+  if (dGeomIsSpace(a) || dGeomIsSpace(b)) {
+    dSpaceCollide2(a, b, data, contactNearCallback);
+    return;
+  }
+
+  World* world = data;
+  Shape* shapeA = dGeomGetData(a);
+  Shape* shapeB = dGeomGetData(b);
+
+  if (!shapeA || !shapeB || isMasked(world, shapeA->collider, shapeB->collider)) {
+    return;
+  }
+
+  dContactGeom contacts[MAX_CONTACTS];
+  int count = dCollide(a, b, MAX_CONTACTS, contacts, sizeof(dContactGeom));
+  world->pairsTested++;
+  world->pairsAccepted += count > 0;
+
+  for (int c = 0; c < count; c++) {
+    dContactGeom* g = &contacts[c];
+    arr_push(&world->contacts, ((Contact) {
+      .a = shapeA,
+      .b = shapeB,
+      .position = { g->pos[0], g->pos[1], g->pos[2] },
+      .normal = { g->normal[0], g->normal[1], g->normal[2] },
+      .depth = g->depth
+    }));
+  }
+}
+
+// Friction and restitution come from the arguments, then the World's table for the pair of tags,
+// then the Colliders.  Without an explicit or per-tag friction, contacts keep infinite friction.
+static void getSurface(World* world, Collider* a, Collider* b, float friction, float restitution, dSurfaceParameters* surface) {
+  uint32_t i = a->tag;
+  uint32_t j = b->tag;
+  bool tagged = i != NO_TAG && j != NO_TAG;
+
+  if (friction < 0.f && tagged) {
+    friction = world->friction[i][j];
+  }
+
+  if (restitution < 0.f && tagged) {
+    restitution = world->restitution[i][j];
+  }
+
+  if (restitution < 0.f) {
+    restitution = MAX(a->restitution, b->restitution);
+  }
+
+  surface->mode = restitution > 0 ? dContactBounce : 0;
+  surface->mu = friction < 0.f ? dInfinity : friction;
+  surface->bounce = restitution;
+}
+
 static void raycastCallback(void* data, dGeomID a, dGeomID b) {
+  if (dGeomIsSpace(b)) {
+    dSpaceCollide2(a, b, data, raycastCallback);
+    return;
+  }
+
   RaycastCallback callback = ((RaycastData*) data)->callback;
   void* userdata = ((RaycastData*) data)->userdata;
   Shape* shape = dGeomGetData(b);
@@ -23,13 +110,209 @@ static void raycastCallback(void* data, dGeomID a, dGeomID b) {
     return;
   }
 
-  dContact contact;
-  if (dCollide(a, b, MAX_CONTACTS, &contact.geom, sizeof(dContact))) {
-    dContactGeom g = contact.geom;
+  dContactGeom contacts[MAX_CONTACTS];
+  if (dCollide(a, b, MAX_CONTACTS, contacts, sizeof(dContactGeom))) {
+    dContactGeom g = contacts[0];
     callback(shape, g.pos[0], g.pos[1], g.pos[2], g.normal[0], g.normal[1], g.normal[2], userdata);
   }
 }
 
+typedef struct {
+  World* world;
+  QueryType type;
+  const float* queries;
+  uint32_t stride;
+  uint32_t count;
+  RaycastHit* hits;
+  uint32_t* hitCounts;
+  uint32_t maxHits;
+} QueryBatch;
+
+// Keeps the nearest maxHits hits, sorted by distance
+static void insertHit(RaycastHit* hits, uint32_t* count, uint32_t maxHits, RaycastHit* hit) {
+  uint32_t i = *count;
+
+  if (i == maxHits) {
+    if (hit->distance >= hits[maxHits - 1].distance) {
+      return;
+    }
+    i--;
+  } else {
+    (*count)++;
+  }
+
+  while (i > 0 && hits[i - 1].distance > hit->distance) {
+    hits[i] = hits[i - 1];
+    i--;
+  }
+
+  hits[i] = *hit;
+}
+
+static bool overlaps(const dReal a[6], const float b[6]) {
+  return a[0] <= b[1] && a[1] >= b[0] && a[2] <= b[3] && a[3] >= b[2] && a[4] <= b[5] && a[5] >= b[4];
+}
+
+static uint32_t castRay(QueryBatch* batch, dGeomID ray, const float* q, RaycastHit* hits) {
+  float dx = q[3] - q[0];
+  float dy = q[4] - q[1];
+  float dz = q[5] - q[2];
+  float length = sqrtf(dx * dx + dy * dy + dz * dz);
+
+  if (length == 0.f) {
+    return 0;
+  }
+
+  dGeomRaySetLength(ray, length);
+  dGeomRaySet(ray, q[0], q[1], q[2], dx, dy, dz);
+
+  float bounds[6] = {
+    MIN(q[0], q[3]), MAX(q[0], q[3]),
+    MIN(q[1], q[4]), MAX(q[1], q[4]),
+    MIN(q[2], q[5]), MAX(q[2], q[5])
+  };
+
+  uint32_t count = 0;
+  QueryShape* shapes = batch->world->queryShapes.data;
+  for (size_t i = 0; i < batch->world->queryShapes.length; i++) {
+    if (!overlaps(shapes[i].aabb, bounds)) {
+      continue;
+    }
+
+    dContactGeom contacts[MAX_CONTACTS];
+    int contactCount = dCollide(ray, shapes[i].shape->id, MAX_CONTACTS, contacts, sizeof(dContactGeom));
+    if (contactCount == 0) {
+      continue;
+    }
+
+    dContactGeom* nearest = &contacts[0];
+    for (int c = 1; c < contactCount; c++) {
+      if (contacts[c].depth < nearest->depth) {
+        nearest = &contacts[c];
+      }
+    }
+
+    RaycastHit hit = {
+      .shape = shapes[i].shape,
+      .position = { nearest->pos[0], nearest->pos[1], nearest->pos[2] },
+      .normal = { nearest->normal[0], nearest->normal[1], nearest->normal[2] },
+      .distance = nearest->depth
+    };
+
+    insertHit(hits, &count, batch->maxHits, &hit);
+  }
+
+  return count;
+}
+
+// ODE can't sweep shapes, so the shape is stepped along the path by its smallest half extent (so
+// consecutive steps overlap), and the first step touching a shape is refined with a bisection.
+static uint32_t sweepShape(QueryBatch* batch, dGeomID geom, const float* q, const float extent[3], RaycastHit* hits) {
+  float direction[3] = { q[3] - q[0], q[4] - q[1], q[5] - q[2] };
+  float length = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+  float step = MIN(MIN(extent[0], extent[1]), extent[2]);
+  uint32_t steps = (length > 0.f && step > 0.f) ? MIN((uint32_t) ceilf(length / step), MAX_SWEEP_STEPS) : 0;
+  QueryShape* shapes = batch->world->queryShapes.data;
+  size_t shapeCount = batch->world->queryShapes.length;
+  uint32_t count = 0;
+
+  for (uint32_t s = 0; s <= steps && count < batch->maxHits; s++) {
+    float t = steps > 0 ? (float) s / steps : 0.f;
+    float position[3] = { q[0] + direction[0] * t, q[1] + direction[1] * t, q[2] + direction[2] * t };
+    float bounds[6] = {
+      position[0] - extent[0], position[0] + extent[0],
+      position[1] - extent[1], position[1] + extent[1],
+      position[2] - extent[2], position[2] + extent[2]
+    };
+
+    dGeomSetPosition(geom, position[0], position[1], position[2]);
+
+    for (size_t i = 0; i < shapeCount; i++) {
+      Shape* shape = shapes[i].shape;
+
+      if (!overlaps(shapes[i].aabb, bounds)) {
+        continue;
+      }
+
+      bool seen = false;
+      for (uint32_t h = 0; h < count && !seen; h++) {
+        seen = hits[h].shape == shape;
+      }
+
+      dContactGeom contact;
+      if (seen || dCollide(geom, shape->id, 1, &contact, sizeof(dContactGeom)) == 0) {
+        continue;
+      }
+
+      float hi = t;
+      if (s > 0) {
+        float lo = (float) (s - 1) / steps;
+        for (uint32_t r = 0; r < SWEEP_REFINEMENT; r++) {
+          float mid = (lo + hi) / 2.f;
+          dContactGeom refined;
+          dGeomSetPosition(geom, q[0] + direction[0] * mid, q[1] + direction[1] * mid, q[2] + direction[2] * mid);
+          if (dCollide(geom, shape->id, 1, &refined, sizeof(dContactGeom))) {
+            contact = refined;
+            hi = mid;
+          } else {
+            lo = mid;
+          }
+        }
+        dGeomSetPosition(geom, position[0], position[1], position[2]);
+      }
+
+      RaycastHit hit = {
+        .shape = shape,
+        .position = { contact.pos[0], contact.pos[1], contact.pos[2] },
+        .normal = { contact.normal[0], contact.normal[1], contact.normal[2] },
+        .distance = hi * length
+      };
+
+      insertHit(hits, &count, batch->maxHits, &hit);
+    }
+  }
+
+  return count;
+}
+
+static void runQueries(void* context, uint32_t index) {
+  QueryBatch* batch = context;
+  QueryGeoms* geoms = &batch->world->queryGeoms[index];
+  uint32_t start = index * QUERY_CHUNK_SIZE;
+  uint32_t end = MIN(start + QUERY_CHUNK_SIZE, batch->count);
+
+  // Collision functions use per-thread caches, this is a no-op for threads that already have them
+  dAllocateODEDataForThread(dAllocateMaskAll);
+
+  for (uint32_t i = start; i < end; i++) {
+    const float* q = batch->queries + i * batch->stride;
+    RaycastHit* hits = batch->hits + i * batch->maxHits;
+    uint32_t count = 0;
+
+    switch (batch->type) {
+      case QUERY_RAY:
+        count = castRay(batch, geoms->ray, q, hits);
+        break;
+      case QUERY_SPHERE:
+        dGeomSphereSetRadius(geoms->sphere, q[6]);
+        count = sweepShape(batch, geoms->sphere, q, (float[3]) { q[6], q[6], q[6] }, hits);
+        break;
+      case QUERY_BOX:
+        dGeomBoxSetLengths(geoms->box, q[6], q[7], q[8]);
+        count = sweepShape(batch, geoms->box, q, (float[3]) { q[6] / 2.f, q[7] / 2.f, q[8] / 2.f }, hits);
+        break;
+    }
+
+    for (uint32_t h = count; h < batch->maxHits; h++) {
+      hits[h] = (RaycastHit) { .shape = NULL, .distance = 0.f };
+    }
+
+    if (batch->hitCounts) {
+      batch->hitCounts[i] = count;
+    }
+  }
+}
+
 // XXX slow, but probably fine (tag names are not on any critical path), could switch to hashing if needed
 static uint32_t findTag(World* world, const char* name) {
   for (uint32_t i = 0; i < MAX_TAGS && world->tags[i]; i++) {
@@ -40,11 +323,134 @@ static uint32_t findTag(World* world, const char* name) {
   return NO_TAG;
 }
 
+// Tags are pushed into the category and collide bits of the geoms, so ODE's broadphase rejects
+// masked pairs before they ever reach the near callback.  Untagged geoms get a category of their
+// own that every tag collides with.
+static void updateGeomBits(World* world, dGeomID geom, uint32_t tag) {
+  if (tag == NO_TAG) {
+    dGeomSetCategoryBits(geom, NO_TAG_BIT);
+    dGeomSetCollideBits(geom, ~0ul);
+  } else {
+    dGeomSetCategoryBits(geom, 1ul << tag);
+    dGeomSetCollideBits(geom, world->masks[tag] | NO_TAG_BIT);
+  }
+}
+
+static void updateColliderBits(Collider* collider) {
+  size_t count;
+  Shape** shapes = lovrColliderGetShapes(collider, &count);
+  for (size_t i = 0; i < count; i++) {
+    updateGeomBits(collider->world, shapes[i]->id, collider->tag);
+  }
+}
+
+static void updateMasks(World* world, uint32_t i, uint32_t j) {
+  for (size_t k = 0; k < world->colliders.length; k++) {
+    Collider* collider = world->colliders.data[k];
+    if (collider->tag == i || collider->tag == j) {
+      updateColliderBits(collider);
+    }
+  }
+
+  if (world->tagSpaces[i]) updateGeomBits(world, (dGeomID) world->tagSpaces[i], i);
+  if (world->tagSpaces[j]) updateGeomBits(world, (dGeomID) world->tagSpaces[j], j);
+}
+
+static dSpaceID createSpace(World* world, dSpaceID parent) {
+  WorldFlags* flags = &world->flags;
+  switch (flags->broadphase) {
+    case BROADPHASE_HASH: {
+      dSpaceID space = dHashSpaceCreate(parent);
+      float size = MAX(MAX(flags->size[0], flags->size[1]), flags->size[2]);
+      dHashSpaceSetLevels(space, (int) floorf(log2f(flags->cellSize)), (int) ceilf(log2f(size)));
+      return space;
+    }
+    case BROADPHASE_SAP:
+      return dSweepAndPruneSpaceCreate(parent, dSAP_AXES_XZY);
+    case BROADPHASE_QUADTREE: {
+      dVector3 center = { flags->center[0], flags->center[1], flags->center[2] };
+      dVector3 extents = { flags->size[0] / 2.f, flags->size[1] / 2.f, flags->size[2] / 2.f };
+      return dQuadTreeSpaceCreate(parent, center, extents, flags->depth);
+    }
+    case BROADPHASE_SIMPLE:
+      return dSimpleSpaceCreate(parent);
+    default: lovrThrow("Unreachable");
+  }
+}
+
+// With tag spaces, each tag gets its own space inside the world's space, so pairs of tags that
+// don't collide are skipped without looking at any of their geoms.
+static dSpaceID getSpace(World* world, uint32_t tag) {
+  if (!world->flags.tagSpaces) {
+    return world->space;
+  }
+
+  uint32_t index = tag == NO_TAG ? MAX_TAGS : tag;
+  if (!world->tagSpaces[index]) {
+    world->tagSpaces[index] = createSpace(world, world->space);
+    updateGeomBits(world, (dGeomID) world->tagSpaces[index], tag);
+  }
+
+  return world->tagSpaces[index];
+}
+
+// Kinematic colliders can go in a separate static space.  It's only collided against the other
+// spaces, since kinematic bodies never push each other.
+static dSpaceID getColliderSpace(Collider* collider) {
+  World* world = collider->world;
+
+  if (world->flags.staticSpace && dBodyIsKinematic(collider->body)) {
+    if (!world->staticSpace) {
+      world->staticSpace = createSpace(world, 0);
+    }
+    return world->staticSpace;
+  }
+
+  return getSpace(world, collider->tag);
+}
+
+static void updateColliderSpace(Collider* collider) {
+  size_t count;
+  Shape** shapes = lovrColliderGetShapes(collider, &count);
+  dSpaceID space = getColliderSpace(collider);
+  for (size_t i = 0; i < count; i++) {
+    if (dGeomGetSpace(shapes[i]->id) != space) {
+      dSpaceRemove(dGeomGetSpace(shapes[i]->id), shapes[i]->id);
+      dSpaceAdd(space, shapes[i]->id);
+    }
+  }
+}
+
+// The world's space only reports pairs of its direct children, so with tag spaces every tag that
+// collides with itself has its own space collided too.  The near callbacks run inside of
+// dSpaceCollide, so the collision time includes the narrowphase as well as the broadphase.
+static void collideWorld(World* world, dNearCallback* callback) {
+  double start = lovrPlatformGetTime();
+
+  dSpaceCollide(world->space, world, callback);
+
+  if (world->flags.tagSpaces) {
+    for (uint32_t i = 0; i <= MAX_TAGS; i++) {
+      if (world->tagSpaces[i] && (i == MAX_TAGS || (world->masks[i] & (1 << i)))) {
+        dSpaceCollide(world->tagSpaces[i], world, callback);
+      }
+    }
+  }
+
+  if (world->staticSpace) {
+    dSpaceCollide2((dGeomID) world->staticSpace, (dGeomID) world->space, world, callback);
+  }
+
+  world->collisionTime += lovrPlatformGetTime() - start;
+}
+
 static bool initialized = false;
+static bool threadedCollision = false;
 
 bool lovrPhysicsInit() {
   if (initialized) return false;
   dInitODE();
+  threadedCollision = dCheckConfiguration("ODE_EXT_mt_collisions");
   return initialized = true;
 }
 
@@ -54,10 +460,10 @@ void lovrPhysicsDestroy() {
   initialized = false;
 }
 
-World* lovrWorldInit(World* world, float xg, float yg, float zg, bool allowSleep, const char** tags, uint32_t tagCount) {
+World* lovrWorldInit(World* world, float xg, float yg, float zg, bool allowSleep, const char** tags, uint32_t tagCount, WorldFlags flags) {
   world->id = dWorldCreate();
-  world->space = dHashSpaceCreate(0);
-  dHashSpaceSetLevels(world->space, -4, 8);
+  world->flags = flags;
+  world->space = flags.tagSpaces ? dSimpleSpaceCreate(0) : createSpace(world, 0);
   world->contactGroup = dJointGroupCreate(0);
   arr_init(&world->overlaps);
   lovrWorldSetGravity(world, xg, yg, zg);
@@ -68,6 +474,19 @@ World* lovrWorldInit(World* world, float xg, float yg, float zg, bool allowSleep
     memcpy(world->tags[i], tags[i], size);
   }
   memset(world->masks, 0xff, sizeof(world->masks));
+  for (uint32_t i = 0; i < MAX_TAGS; i++) {
+    for (uint32_t j = 0; j < MAX_TAGS; j++) {
+      world->friction[i][j] = -1.f;
+      world->restitution[i][j] = -1.f;
+    }
+  }
+  arr_init(&world->contacts);
+  arr_init(&world->queryShapes);
+  arr_init(&world->colliders);
+  if (flags.tagSpaces) {
+    getSpace(world, NO_TAG);
+  }
+  lovrWorldSetWorkerCount(world, flags.workers);
   return world;
 }
 
@@ -75,18 +494,30 @@ void lovrWorldDestroy(void* ref) {
   World* world = ref;
   lovrWorldDestroyData(world);
   arr_free(&world->overlaps);
+  arr_free(&world->queryShapes);
+  arr_free(&world->contacts);
+  arr_free(&world->colliders);
   for (uint32_t i = 0; i < MAX_TAGS && world->tags[i]; i++) {
     free(world->tags[i]);
   }
 }
 
 void lovrWorldDestroyData(World* world) {
-  while (world->head) {
-    Collider* next = world->head->next;
-    lovrColliderDestroyData(world->head);
-    world->head = next;
+  while (world->colliders.length > 0) {
+    lovrColliderDestroyData(world->colliders.data[world->colliders.length - 1]);
   }
 
+  arr_clear(&world->contacts);
+
+  for (uint32_t i = 0; i < world->queryGeomCount; i++) {
+    dGeomDestroy(world->queryGeoms[i].ray);
+    dGeomDestroy(world->queryGeoms[i].sphere);
+    dGeomDestroy(world->queryGeoms[i].box);
+  }
+  free(world->queryGeoms);
+  world->queryGeoms = NULL;
+  world->queryGeomCount = 0;
+
   if (world->contactGroup) {
     dJointGroupDestroy(world->contactGroup);
     world->contactGroup = NULL;
@@ -95,19 +526,26 @@ void lovrWorldDestroyData(World* world) {
   if (world->space) {
     dSpaceDestroy(world->space);
     world->space = NULL;
+    memset(world->tagSpaces, 0, sizeof(world->tagSpaces));
+  }
+
+  if (world->staticSpace) {
+    dSpaceDestroy(world->staticSpace);
+    world->staticSpace = NULL;
   }
 
   if (world->id) {
+    lovrWorldSetWorkerCount(world, 0);
     dWorldDestroy(world->id);
     world->id = NULL;
   }
 }
 
-void lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* userdata) {
+static void stepWorld(World* world, float dt, CollisionResolver resolver, void* userdata) {
   if (resolver) {
     resolver(world, userdata);
   } else {
-    dSpaceCollide(world->space, world, defaultNearCallback);
+    collideWorld(world, defaultNearCallback);
   }
 
   if (dt > 0) {
@@ -117,9 +555,44 @@ void lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* u
   dJointGroupEmpty(world->contactGroup);
 }
 
+// With a fixed timestep, time accumulates until there's enough for a step, and each step runs the
+// collision resolver again.  If the world falls too far behind, the extra whole steps are dropped
+// instead of running more than maxSteps steps, but the leftover partial step is kept.  The pose of
+// each Collider before the last step is kept around so poses can be interpolated by the leftover
+// time.
+void lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* userdata) {
+  world->pairsTested = 0;
+  world->pairsAccepted = 0;
+  world->collisionTime = 0.;
+
+  if (world->timestep <= 0.f) {
+    stepWorld(world, dt, resolver, userdata);
+    return;
+  }
+
+  world->accumulator += dt;
+  uint32_t steps = (uint32_t) (world->accumulator / world->timestep);
+
+  if (steps > world->maxSteps) {
+    steps = world->maxSteps;
+    world->accumulator = steps * world->timestep + fmodf(world->accumulator, world->timestep);
+  }
+
+  for (uint32_t i = 0; i < steps; i++) {
+    for (size_t j = 0; j < world->colliders.length; j++) {
+      Collider* collider = world->colliders.data[j];
+      lovrColliderGetPosition(collider, &collider->lastPosition[0], &collider->lastPosition[1], &collider->lastPosition[2]);
+      lovrColliderGetOrientation(collider, collider->lastOrientation);
+    }
+
+    stepWorld(world, world->timestep, resolver, userdata);
+    world->accumulator -= world->timestep;
+  }
+}
+
 void lovrWorldComputeOverlaps(World* world) {
   arr_clear(&world->overlaps);
-  dSpaceCollide(world->space, world, customNearCallback);
+  collideWorld(world, customNearCallback);
 }
 
 int lovrWorldGetNextOverlap(World* world, Shape** a, Shape** b) {
@@ -140,34 +613,22 @@ int lovrWorldCollide(World* world, Shape* a, Shape* b, float friction, float res
 
   Collider* colliderA = a->collider;
   Collider* colliderB = b->collider;
-  uint32_t i = colliderA->tag;
-  uint32_t j = colliderB->tag;
+  world->pairsTested++;
 
-  if (i != NO_TAG && j != NO_TAG && !((world->masks[i] & (1 << j)) && (world->masks[j] & (1 << i)))) {
+  if (isMasked(world, colliderA, colliderB)) {
     return false;
   }
 
-  if (friction < 0.f) {
-    friction = sqrtf(colliderA->friction * colliderB->friction);
-  }
-
-  if (restitution < 0.f) {
-    restitution = MAX(colliderA->restitution, colliderB->restitution);
-  }
+  dSurfaceParameters surface;
+  getSurface(world, colliderA, colliderB, friction, restitution, &surface);
 
   dContact contacts[MAX_CONTACTS];
   for (int c = 0; c < MAX_CONTACTS; c++) {
-    contacts[c].surface.mode = 0;
-    contacts[c].surface.mu = friction;
-    contacts[c].surface.bounce = restitution;
-    contacts[c].surface.mu = dInfinity;
-
-    if (restitution > 0) {
-      contacts[c].surface.mode |= dContactBounce;
-    }
+    contacts[c].surface = surface;
   }
 
   int contactCount = dCollide(a->id, b->id, MAX_CONTACTS, &contacts[0].geom, sizeof(dContact));
+  world->pairsAccepted += contactCount > 0;
 
   if (!a->sensor && !b->sensor) {
     for (int c = 0; c < contactCount; c++) {
@@ -179,8 +640,334 @@ int lovrWorldCollide(World* world, Shape* a, Shape* b, float friction, float res
   return contactCount;
 }
 
-Collider* lovrWorldGetFirstCollider(World* world) {
-  return world->head;
+// Contacts are written to a buffer on the World instead of being turned into joints, so they can be
+// looked at (or thrown away) before they are resolved
+uint32_t lovrWorldComputeContacts(World* world) {
+  arr_clear(&world->contacts);
+  collideWorld(world, contactNearCallback);
+  return world->contacts.length;
+}
+
+Contact* lovrWorldGetContacts(World* world, uint32_t* count) {
+  *count = world->contacts.length;
+  return world->contacts.data;
+}
+
+void lovrWorldResolveContacts(World* world) {
+  for (size_t i = 0; i < world->contacts.length; i++) {
+    Contact* contact = &world->contacts.data[i];
+    Shape* a = contact->a;
+    Shape* b = contact->b;
+
+    if (!a->collider || !b->collider || a->sensor || b->sensor) {
+      continue;
+    }
+
+    dContact c = {
+      .geom.pos = { contact->position[0], contact->position[1], contact->position[2] },
+      .geom.normal = { contact->normal[0], contact->normal[1], contact->normal[2] },
+      .geom.depth = contact->depth,
+      .geom.g1 = a->id,
+      .geom.g2 = b->id
+    };
+
+    getSurface(world, a->collider, b->collider, -1.f, -1.f, &c.surface);
+    dJointID joint = dJointCreateContact(world->id, world->contactGroup, &c);
+    dJointAttach(joint, a->collider->body, b->collider->body);
+  }
+}
+
+Collider** lovrWorldGetColliders(World* world, size_t* count) {
+  *count = world->colliders.length;
+  return world->colliders.data;
+}
+
+// Each collider writes to the slot at its index in the collider list, so slots stay put while
+// colliders sleep.  Matrices are column major, for use as instance transforms.
+uint32_t lovrWorldGetPoses(World* world, float* data, PoseFormat format, bool awakeOnly) {
+  uint32_t count = 0;
+  size_t stride = format == POSE_MATRIX ? 16 : 8;
+  for (size_t i = 0; i < world->colliders.length; i++) {
+    Collider* collider = world->colliders.data[i];
+    if (awakeOnly && !lovrColliderIsAwake(collider)) {
+      continue;
+    }
+
+    float position[4], orientation[4];
+    lovrColliderGetInterpolatedPose(collider, position, orientation);
+    float* pose = data + i * stride;
+
+    if (format == POSE_MATRIX) {
+      mat4_fromQuat(pose, orientation);
+      pose[12] = position[0];
+      pose[13] = position[1];
+      pose[14] = position[2];
+    } else {
+      vec3_init(pose, position);
+      pose[3] = 1.f;
+      quat_init(pose + 4, orientation);
+    }
+
+    count++;
+  }
+  return count;
+}
+
+// A snapshot is a header followed by a record for every collider, then every shape, then every
+// joint, all in World order.  It only holds state that changes while the World runs, so it can be
+// restored onto the same World (or one built the same way) without creating any objects.
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t colliderCount;
+  uint32_t shapeCount;
+  uint32_t jointCount;
+  float accumulator;
+} SnapshotHeader;
+
+typedef struct {
+  float position[3];
+  float orientation[4];
+  float linearVelocity[3];
+  float angularVelocity[3];
+  float force[3];
+  float torque[3];
+  float lastPosition[3];
+  float lastOrientation[4];
+  uint32_t flags;
+} ColliderState;
+
+typedef struct {
+  float position[3];
+  float orientation[4];
+  uint32_t flags;
+} ShapeState;
+
+typedef struct {
+  uint32_t type;
+  uint32_t enabled;
+  float cfm;
+  float erp;
+  float params[2];
+} JointState;
+
+#define SNAPSHOT_VERSION 1
+
+enum {
+  STATE_AWAKE = 1,
+  STATE_KINEMATIC = 2,
+  STATE_GRAVITY_IGNORED = 4,
+  STATE_ENABLED = 8,
+  STATE_SENSOR = 16
+};
+
+// Joints are stored with the first collider they're attached to, so each one is only stored once
+static bool ownsJoint(Collider* collider, Joint* joint) {
+  dBodyID body = dJointGetBody(joint->id, 0);
+  return body ? body == collider->body : dJointGetBody(joint->id, 1) == collider->body;
+}
+
+static void countSnapshot(World* world, uint32_t* shapeCount, uint32_t* jointCount) {
+  *shapeCount = *jointCount = 0;
+  for (size_t i = 0; i < world->colliders.length; i++) {
+    Collider* collider = world->colliders.data[i];
+    size_t count;
+    lovrColliderGetShapes(collider, &count);
+    *shapeCount += count;
+    Joint** joints = lovrColliderGetJoints(collider, &count);
+    for (size_t j = 0; j < count; j++) {
+      *jointCount += ownsJoint(collider, joints[j]);
+    }
+  }
+}
+
+// Returns the size of the snapshot, and only writes it if it fits in the buffer
+size_t lovrWorldSnapshot(World* world, void* data, size_t size) {
+  uint32_t shapeCount, jointCount;
+  countSnapshot(world, &shapeCount, &jointCount);
+  uint32_t colliderCount = (uint32_t) world->colliders.length;
+
+  size_t total = sizeof(SnapshotHeader) +
+    colliderCount * sizeof(ColliderState) +
+    shapeCount * sizeof(ShapeState) +
+    jointCount * sizeof(JointState);
+
+  if (!data || size < total) {
+    return total;
+  }
+
+  SnapshotHeader header = {
+    .magic = { 'L', 'W', 'L', 'D' },
+    .version = SNAPSHOT_VERSION,
+    .colliderCount = colliderCount,
+    .shapeCount = shapeCount,
+    .jointCount = jointCount,
+    .accumulator = world->accumulator
+  };
+
+  char* cursor = data;
+  memcpy(cursor, &header, sizeof(header));
+  cursor += sizeof(header);
+
+  ColliderState* colliders = (ColliderState*) cursor;
+  ShapeState* shapes = (ShapeState*) (colliders + colliderCount);
+  JointState* joints = (JointState*) (shapes + shapeCount);
+
+  for (size_t i = 0; i < colliderCount; i++) {
+    Collider* collider = world->colliders.data[i];
+    ColliderState* state = &colliders[i];
+    lovrColliderGetPosition(collider, &state->position[0], &state->position[1], &state->position[2]);
+    lovrColliderGetOrientation(collider, state->orientation);
+    lovrColliderGetLinearVelocity(collider, &state->linearVelocity[0], &state->linearVelocity[1], &state->linearVelocity[2]);
+    lovrColliderGetAngularVelocity(collider, &state->angularVelocity[0], &state->angularVelocity[1], &state->angularVelocity[2]);
+    const dReal* force = dBodyGetForce(collider->body);
+    const dReal* torque = dBodyGetTorque(collider->body);
+    for (int j = 0; j < 3; j++) {
+      state->force[j] = force[j];
+      state->torque[j] = torque[j];
+      state->lastPosition[j] = collider->lastPosition[j];
+    }
+    memcpy(state->lastOrientation, collider->lastOrientation, 4 * sizeof(float));
+    state->flags =
+      (lovrColliderIsAwake(collider) ? STATE_AWAKE : 0) |
+      (lovrColliderIsKinematic(collider) ? STATE_KINEMATIC : 0) |
+      (lovrColliderIsGravityIgnored(collider) ? STATE_GRAVITY_IGNORED : 0);
+
+    size_t count;
+    Shape** colliderShapes = lovrColliderGetShapes(collider, &count);
+    for (size_t j = 0; j < count; j++, shapes++) {
+      Shape* shape = colliderShapes[j];
+      lovrShapeGetPosition(shape, &shapes->position[0], &shapes->position[1], &shapes->position[2]);
+      lovrShapeGetOrientation(shape, shapes->orientation);
+      shapes->flags = (lovrShapeIsEnabled(shape) ? STATE_ENABLED : 0) | (lovrShapeIsSensor(shape) ? STATE_SENSOR : 0);
+    }
+
+    Joint** colliderJoints = lovrColliderGetJoints(collider, &count);
+    for (size_t j = 0; j < count; j++) {
+      Joint* joint = colliderJoints[j];
+      if (!ownsJoint(collider, joint)) continue;
+      joints->type = joint->type;
+      joints->enabled = lovrJointIsEnabled(joint);
+      joints->cfm = lovrJointGetCFM(joint);
+      joints->erp = lovrJointGetERP(joint);
+      switch (joint->type) {
+        case JOINT_DISTANCE:
+          joints->params[0] = lovrDistanceJointGetDistance(joint);
+          joints->params[1] = 0.f;
+          break;
+        case JOINT_HINGE:
+          joints->params[0] = lovrHingeJointGetLowerLimit(joint);
+          joints->params[1] = lovrHingeJointGetUpperLimit(joint);
+          break;
+        case JOINT_SLIDER:
+          joints->params[0] = lovrSliderJointGetLowerLimit(joint);
+          joints->params[1] = lovrSliderJointGetUpperLimit(joint);
+          break;
+        default:
+          joints->params[0] = joints->params[1] = 0.f;
+          break;
+      }
+      joints++;
+    }
+  }
+
+  return total;
+}
+
+void lovrWorldRestore(World* world, const void* data, size_t size) {
+  SnapshotHeader header;
+  lovrAssert(size >= sizeof(header), "Invalid World snapshot");
+  memcpy(&header, data, sizeof(header));
+  lovrAssert(!memcmp(header.magic, "LWLD", 4), "Invalid World snapshot");
+  lovrAssert(header.version == SNAPSHOT_VERSION, "Unsupported World snapshot version %d", header.version);
+
+  uint32_t shapeCount, jointCount;
+  countSnapshot(world, &shapeCount, &jointCount);
+  lovrAssert(header.colliderCount == world->colliders.length, "Snapshot has %d colliders, but the World has %d", header.colliderCount, (int) world->colliders.length);
+  lovrAssert(header.shapeCount == shapeCount, "Snapshot has %d shapes, but the World has %d", header.shapeCount, shapeCount);
+  lovrAssert(header.jointCount == jointCount, "Snapshot has %d joints, but the World has %d", header.jointCount, jointCount);
+
+  size_t total = sizeof(header) +
+    header.colliderCount * sizeof(ColliderState) +
+    header.shapeCount * sizeof(ShapeState) +
+    header.jointCount * sizeof(JointState);
+  lovrAssert(size >= total, "World snapshot is truncated");
+
+  const ColliderState* colliders = (const ColliderState*) ((const char*) data + sizeof(header));
+  const ShapeState* shapes = (const ShapeState*) (colliders + header.colliderCount);
+  const JointState* joints = (const JointState*) (shapes + header.shapeCount);
+
+  // Joint types are checked before anything changes, so a mismatched snapshot leaves the World alone
+  const JointState* joint = joints;
+  for (size_t i = 0; i < world->colliders.length; i++) {
+    Collider* collider = world->colliders.data[i];
+    size_t count;
+    Joint** colliderJoints = lovrColliderGetJoints(collider, &count);
+    for (size_t j = 0; j < count; j++) {
+      if (ownsJoint(collider, colliderJoints[j])) {
+        lovrAssert(joint->type == colliderJoints[j]->type, "Snapshot does not match the World's joints");
+        joint++;
+      }
+    }
+  }
+
+  world->accumulator = header.accumulator;
+
+  for (size_t i = 0; i < world->colliders.length; i++) {
+    Collider* collider = world->colliders.data[i];
+    const ColliderState* state = &colliders[i];
+
+    bool kinematic = state->flags & STATE_KINEMATIC;
+    if (kinematic != lovrColliderIsKinematic(collider)) {
+      lovrColliderSetKinematic(collider, kinematic);
+    }
+
+    lovrColliderSetPosition(collider, state->position[0], state->position[1], state->position[2]);
+    lovrColliderSetOrientation(collider, (float*) state->orientation);
+    lovrColliderSetLinearVelocity(collider, state->linearVelocity[0], state->linearVelocity[1], state->linearVelocity[2]);
+    lovrColliderSetAngularVelocity(collider, state->angularVelocity[0], state->angularVelocity[1], state->angularVelocity[2]);
+    dBodySetForce(collider->body, state->force[0], state->force[1], state->force[2]);
+    dBodySetTorque(collider->body, state->torque[0], state->torque[1], state->torque[2]);
+    vec3_set(collider->lastPosition, state->lastPosition[0], state->lastPosition[1], state->lastPosition[2]);
+    memcpy(collider->lastOrientation, state->lastOrientation, 4 * sizeof(float));
+    lovrColliderSetGravityIgnored(collider, state->flags & STATE_GRAVITY_IGNORED);
+    lovrColliderSetAwake(collider, state->flags & STATE_AWAKE);
+
+    size_t count;
+    Shape** colliderShapes = lovrColliderGetShapes(collider, &count);
+    for (size_t j = 0; j < count; j++, shapes++) {
+      Shape* shape = colliderShapes[j];
+      lovrShapeSetPosition(shape, shapes->position[0], shapes->position[1], shapes->position[2]);
+      lovrShapeSetOrientation(shape, (float*) shapes->orientation);
+      lovrShapeSetEnabled(shape, shapes->flags & STATE_ENABLED);
+      lovrShapeSetSensor(shape, shapes->flags & STATE_SENSOR);
+    }
+
+    Joint** colliderJoints = lovrColliderGetJoints(collider, &count);
+    for (size_t j = 0; j < count; j++) {
+      Joint* joint = colliderJoints[j];
+      if (!ownsJoint(collider, joint)) continue;
+      lovrJointSetEnabled(joint, joints->enabled);
+      lovrJointSetCFM(joint, joints->cfm);
+      lovrJointSetERP(joint, joints->erp);
+      switch (joint->type) {
+        case JOINT_DISTANCE:
+          lovrDistanceJointSetDistance(joint, joints->params[0]);
+          break;
+        case JOINT_HINGE:
+          lovrHingeJointSetLowerLimit(joint, joints->params[0]);
+          lovrHingeJointSetUpperLimit(joint, joints->params[1]);
+          break;
+        case JOINT_SLIDER:
+          lovrSliderJointSetLowerLimit(joint, joints->params[0]);
+          lovrSliderJointSetUpperLimit(joint, joints->params[1]);
+          break;
+        default:
+          break;
+      }
+      joints++;
+    }
+  }
 }
 
 void lovrWorldGetGravity(World* world, float* x, float* y, float* z) {
@@ -239,18 +1026,101 @@ void lovrWorldSetSleepingAllowed(World* world, bool allowed) {
   dWorldSetAutoDisableFlag(world->id, allowed);
 }
 
+static void reserveQueryGeoms(World* world, uint32_t count) {
+  if (world->queryGeomCount >= count) {
+    return;
+  }
+
+  world->queryGeoms = realloc(world->queryGeoms, count * sizeof(QueryGeoms));
+  lovrAssert(world->queryGeoms, "Out of memory");
+
+  for (uint32_t i = world->queryGeomCount; i < count; i++) {
+    world->queryGeoms[i].ray = dCreateRay(0, 1.f);
+    world->queryGeoms[i].sphere = dCreateSphere(0, 1.f);
+    world->queryGeoms[i].box = dCreateBox(0, 1.f, 1.f, 1.f);
+  }
+
+  world->queryGeomCount = count;
+}
+
 void lovrWorldRaycast(World* world, float x1, float y1, float z1, float x2, float y2, float z2, RaycastCallback callback, void* userdata) {
   RaycastData data = { .callback = callback, .userdata = userdata };
   float dx = x2 - x1;
   float dy = y2 - y1;
   float dz = z2 - z1;
   float length = sqrtf(dx * dx + dy * dy + dz * dz);
-  dGeomID ray = dCreateRay(world->space, length);
+  // The callback can raycast again, so the ray can't come from the shared query geoms
+  dGeomID ray = dCreateRay(0, length);
   dGeomRaySet(ray, x1, y1, z1, dx, dy, dz);
   dSpaceCollide2(ray, (dGeomID) world->space, &data, raycastCallback);
+  if (world->staticSpace) {
+    dSpaceCollide2(ray, (dGeomID) world->staticSpace, &data, raycastCallback);
+  }
   dGeomDestroy(ray);
 }
 
+// Queries are split into chunks that run as jobs.  ODE spaces aren't safe to share between threads
+// (even reading them updates internal state), so the bounding boxes of the shapes are copied into
+// a flat list first and each job does its own broadphase against that list.  This is the same
+// linear scan that dSpaceCollide2 does for a single geom.
+uint32_t lovrWorldQueryMany(World* world, QueryType type, const float* queries, uint32_t count, RaycastHit* hits, uint32_t* hitCounts, uint32_t maxHits) {
+  static const uint32_t strides[] = { [QUERY_RAY] = 6, [QUERY_SPHERE] = 7, [QUERY_BOX] = 9 };
+  lovrAssert(maxHits > 0, "Queries need room for at least one hit");
+
+  if (count == 0) {
+    return 0;
+  }
+
+  uint32_t chunks = (count + QUERY_CHUNK_SIZE - 1) / QUERY_CHUNK_SIZE;
+  reserveQueryGeoms(world, chunks);
+
+  arr_clear(&world->queryShapes);
+  for (size_t c = 0; c < world->colliders.length; c++) {
+    Collider* collider = world->colliders.data[c];
+    size_t shapeCount;
+    Shape** shapes = lovrColliderGetShapes(collider, &shapeCount);
+    for (size_t i = 0; i < shapeCount; i++) {
+      Shape* shape = shapes[i];
+      if (dGeomIsEnabled(shape->id)) {
+        QueryShape entry = { .shape = shape };
+        dGeomGetAABB(shape->id, entry.aabb);
+        arr_push(&world->queryShapes, entry);
+      }
+    }
+  }
+
+  QueryBatch batch = {
+    .world = world,
+    .type = type,
+    .queries = queries,
+    .stride = strides[type],
+    .count = count,
+    .hits = hits,
+    .hitCounts = hitCounts,
+    .maxHits = maxHits
+  };
+
+  // Without thread local collision caches (ODE_WITH_OU), collision checks have to stay on one thread
+  if (threadedCollision) {
+    JobCounter counter = { 0 };
+    job_run(runQueries, &batch, chunks, &counter, NULL);
+    job_wait(&counter);
+  } else {
+    for (uint32_t i = 0; i < chunks; i++) {
+      runQueries(&batch, i);
+    }
+  }
+
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    for (uint32_t h = 0; h < maxHits && hits[i * maxHits + h].shape; h++) {
+      total++;
+    }
+  }
+
+  return total;
+}
+
 const char* lovrWorldGetTagName(World* world, uint32_t tag) {
   return (tag == NO_TAG) ? NULL : world->tags[tag];
 }
@@ -264,6 +1134,7 @@ int lovrWorldDisableCollisionBetween(World* world, const char* tag1, const char*
 
   world->masks[i] &= ~(1 << j);
   world->masks[j] &= ~(1 << i);
+  updateMasks(world, i, j);
   return 0;
 }
 
@@ -276,6 +1147,7 @@ int lovrWorldEnableCollisionBetween(World* world, const char* tag1, const char*
 
   world->masks[i] |= (1 << j);
   world->masks[j] |= (1 << i);
+  updateMasks(world, i, j);
   return 0;
 }
 
@@ -289,26 +1161,116 @@ int lovrWorldIsCollisionEnabledBetween(World* world, const char* tag1, const cha
   return (world->masks[i] & (1 << j)) && (world->masks[j] & (1 << i));
 }
 
+bool lovrWorldGetMaterial(World* world, const char* tag1, const char* tag2, float* friction, float* restitution) {
+  uint32_t i = findTag(world, tag1);
+  uint32_t j = findTag(world, tag2);
+  if (i == NO_TAG || j == NO_TAG) {
+    return false;
+  }
+
+  *friction = world->friction[i][j];
+  *restitution = world->restitution[i][j];
+  return true;
+}
+
+// Negative values mean the pair of tags doesn't override the Colliders
+bool lovrWorldSetMaterial(World* world, const char* tag1, const char* tag2, float friction, float restitution) {
+  uint32_t i = findTag(world, tag1);
+  uint32_t j = findTag(world, tag2);
+  if (i == NO_TAG || j == NO_TAG) {
+    return false;
+  }
+
+  world->friction[i][j] = world->friction[j][i] = friction;
+  world->restitution[i][j] = world->restitution[j][i] = restitution;
+  return true;
+}
+
+void lovrWorldGetPairCounts(World* world, uint32_t* tested, uint32_t* accepted) {
+  *tested = world->pairsTested;
+  *accepted = world->pairsAccepted;
+}
+
+double lovrWorldGetCollisionTime(World* world) {
+  return world->collisionTime;
+}
+
+void lovrWorldGetTimestep(World* world, float* timestep, uint32_t* maxSteps) {
+  *timestep = world->timestep;
+  *maxSteps = world->maxSteps;
+}
+
+void lovrWorldSetTimestep(World* world, float timestep, uint32_t maxSteps) {
+  world->timestep = timestep;
+  world->maxSteps = maxSteps;
+  world->accumulator = 0.f;
+}
+
+uint32_t lovrWorldGetIterations(World* world) {
+  return dWorldGetQuickStepNumIterations(world->id);
+}
+
+void lovrWorldSetIterations(World* world, uint32_t iterations) {
+  dWorldSetQuickStepNumIterations(world->id, iterations);
+}
+
+float lovrWorldGetInterpolation(World* world) {
+  return world->timestep > 0.f ? world->accumulator / world->timestep : 1.f;
+}
+
+uint32_t lovrWorldGetWorkerCount(World* world) {
+  return world->workerCount;
+}
+
+// Worlds with workers step their islands on a pool of ODE threads.  Islands are found in the same
+// order every step and each one is solved on its own, so the results don't depend on which thread
+// solves which island.  Like the job system, the worker count is capped at MAX_WORKERS.
+void lovrWorldSetWorkerCount(World* world, uint32_t workers) {
+  workers = MIN(workers, MAX_WORKERS);
+  if (world->workerCount == workers) {
+    return;
+  }
+
+  if (world->threading) {
+    dThreadingImplementationShutdownProcessing(world->threading);
+    dThreadingFreeThreadPool(world->threadPool);
+    dWorldSetStepThreadingImplementation(world->id, NULL, NULL);
+    dThreadingFreeImplementation(world->threading);
+    world->threading = NULL;
+    world->threadPool = NULL;
+    world->workerCount = 0;
+  }
+
+  if (workers == 0) {
+    return;
+  }
+
+  world->threading = dThreadingAllocateMultiThreadedImplementation();
+  lovrAssert(world->threading, "This version of ODE does not support multithreaded stepping");
+  world->threadPool = dThreadingAllocateThreadPool(workers, 0, dAllocateFlagBasicData, NULL);
+  lovrAssert(world->threadPool, "Could not create physics worker threads");
+  dThreadingThreadPoolServeMultiThreadedImplementation(world->threadPool, world->threading);
+  dWorldSetStepThreadingImplementation(world->id, dThreadingImplementationGetFunctions(world->threading), world->threading);
+  dWorldSetStepIslandsProcessingMaxThreadCount(world->id, workers);
+  world->workerCount = workers;
+}
+
 Collider* lovrColliderInit(Collider* collider, World* world, float x, float y, float z) {
   collider->body = dBodyCreate(world->id);
   collider->world = world;
   collider->friction = 0;
   collider->restitution = 0;
   collider->tag = NO_TAG;
+  quat_set(collider->lastOrientation, 0.f, 0.f, 0.f, 1.f);
   dBodySetData(collider->body, collider);
   arr_init(&collider->shapes);
   arr_init(&collider->joints);
 
   lovrColliderSetPosition(collider, x, y, z);
 
-  // Adjust the world's collider list
-  if (!collider->world->head) {
-    collider->world->head = collider;
-  } else {
-    collider->next = collider->world->head;
-    collider->next->prev = collider;
-    collider->world->head = collider;
-  }
+  // Add the collider to the world's collider list
+  collider->index = (uint32_t) world->colliders.length;
+  arr_push(&world->colliders, collider);
 
   // The world owns a reference to the collider
   lovrRetain(collider);
@@ -341,11 +1303,15 @@ void lovrColliderDestroyData(Collider* collider) {
 
   dBodyDestroy(collider->body);
   collider->body = NULL;
-
-  if (collider->next) collider->next->prev = collider->prev;
-  if (collider->prev) collider->prev->next = collider->next;
-  if (collider->world->head == collider) collider->world->head = collider->next;
-  collider->next = collider->prev = NULL;
+  arr_clear(&collider->world->contacts);
+
+  // The last collider takes this collider's slot, which keeps the list dense
+  World* world = collider->world;
+  Collider* last = arr_pop(&world->colliders);
+  if (last != collider) {
+    world->colliders.data[collider->index] = last;
+    last->index = collider->index;
+  }
 
   // If the Collider is destroyed, the world lets go of its reference to this Collider
   lovrRelease(Collider, collider);
@@ -372,13 +1338,16 @@ void lovrColliderAddShape(Collider* collider, Shape* shape) {
 
   shape->collider = collider;
   dGeomSetBody(shape->id, collider->body);
-  dSpaceID newSpace = collider->world->space;
+  dSpaceID newSpace = getColliderSpace(collider);
   dSpaceAdd(newSpace, shape->id);
+  updateGeomBits(collider->world, shape->id, collider->tag);
 }
 
 void lovrColliderRemoveShape(Collider* collider, Shape* shape) {
   if (shape->collider == collider) {
-    dSpaceRemove(collider->world->space, shape->id);
+    // Computed contacts point at Shapes, and the Shape might not be around for much longer
+    arr_clear(&collider->world->contacts);
+    dSpaceRemove(dGeomGetSpace(shape->id), shape->id);
     dGeomSetBody(shape->id, 0);
     shape->collider = NULL;
     lovrRelease(Shape, shape);
@@ -423,13 +1392,10 @@ const char* lovrColliderGetTag(Collider* collider) {
 }
 
 bool lovrColliderSetTag(Collider* collider, const char* tag) {
-  if (!tag) {
-    collider->tag = NO_TAG;
-    return true;
-  }
-
-  collider->tag = findTag(collider->world, tag);
-  return collider->tag != NO_TAG;
+  collider->tag = tag ? findTag(collider->world, tag) : NO_TAG;
+  updateColliderSpace(collider);
+  updateColliderBits(collider);
+  return !tag || collider->tag != NO_TAG;
 }
 
 float lovrColliderGetFriction(Collider* collider) {
@@ -458,6 +1424,8 @@ void lovrColliderSetKinematic(Collider* collider, bool kinematic) {
   } else {
     dBodySetDynamic(collider->body);
   }
+
+  updateColliderSpace(collider);
 }
 
 bool lovrColliderIsGravityIgnored(Collider* collider) {
@@ -534,8 +1502,10 @@ void lovrColliderGetPosition(Collider* collider, float* x, float* y, float* z) {
   *z = position[2];
 }
 
+// Moving a Collider directly also moves its last pose, so it doesn't get interpolated
 void lovrColliderSetPosition(Collider* collider, float x, float y, float z) {
   dBodySetPosition(collider->body, x, y, z);
+  vec3_set(collider->lastPosition, x, y, z);
 }
 
 void lovrColliderGetOrientation(Collider* collider, quat orientation) {
@@ -546,6 +1516,23 @@ void lovrColliderGetOrientation(Collider* collider, quat orientation) {
 void lovrColliderSetOrientation(Collider* collider, quat orientation) {
   float q[4] = { orientation[3], orientation[0], orientation[1], orientation[2] };
   dBodySetQuaternion(collider->body, q);
+  quat_init(collider->lastOrientation, orientation);
+}
+
+void lovrColliderGetInterpolatedPose(Collider* collider, vec3 position, quat orientation) {
+  float current[4] = { 0.f };
+  lovrColliderGetPosition(collider, &current[0], &current[1], &current[2]);
+
+  if (collider->world->timestep <= 0.f) {
+    vec3_init(position, current);
+    lovrColliderGetOrientation(collider, orientation);
+    return;
+  }
+
+  float t = lovrWorldGetInterpolation(collider->world);
+  vec3_lerp(vec3_init(position, collider->lastPosition), current, t);
+  lovrColliderGetOrientation(collider, current);
+  quat_slerp(quat_init(orientation, collider->lastOrientation), current, t);
 }
 
 void lovrColliderGetLinearVelocity(Collider* collider, float* x, float* y, float* z) {
@@ -687,12 +1674,10 @@ void lovrShapeDestroy(void* ref) {
 
 void lovrShapeDestroyData(Shape* shape) {
   if (shape->id) {
-    if (shape->type == SHAPE_MESH) {
-      dTriMeshDataID dataID = dGeomTriMeshGetData(shape->id);
-      dGeomTriMeshDataDestroy(dataID);
-    }
     dGeomDestroy(shape->id);
     shape->id = NULL;
+    lovrRelease(TriMesh, shape->trimesh);
+    shape->trimesh = NULL;
   }
 }
 
@@ -905,17 +1890,222 @@ void lovrCylinderShapeSetLength(CylinderShape* cylinder, float length) {
   dGeomCylinderSetParams(cylinder->id, lovrCylinderShapeGetRadius(cylinder), length);
 }
 
-MeshShape* lovrMeshShapeInit(MeshShape* mesh, int vertexCount, float vertices[], int indexCount, dTriIndex indices[]) {
-  dTriMeshDataID dataID = dGeomTriMeshDataCreate();
-  dGeomTriMeshDataBuildSingle(dataID, vertices, 3 * sizeof(float), vertexCount, 
-                              indices, indexCount, 3 * sizeof(dTriIndex));
-  dGeomTriMeshDataPreprocess2(dataID, (1U << dTRIDATAPREPROCESS_BUILD_FACE_ANGLES), NULL);
-  mesh->id = dCreateTriMesh(0, dataID, 0, 0, 0);
+// Cooked TriMesh data is a header followed by the vertices (3 floats each), the indices, and a byte
+// of ODE's edge and vertex use flags for each triangle
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t indexSize;
+  uint32_t vertexCount;
+  uint32_t indexCount;
+} TriMeshHeader;
+
+#define TRIMESH_VERSION 2
+
+// TriMeshes loaded from cooked data, by Blob, so every MeshShape made from a Blob shares one TriMesh
+static map_t cookedMeshes;
+
+// The collision data is built the first time a MeshShape uses the TriMesh.  ODE has no way to load
+// its collision tree, so that is always built here, but cooked meshes come with use flags and skip
+// the preprocessing step.
+static dTriMeshDataID getTriMeshData(TriMesh* trimesh) {
+  if (!trimesh->id) {
+    lovrAssert(trimesh->indexCount % 3 == 0, "TriMesh index count must be a multiple of 3");
+    trimesh->id = dGeomTriMeshDataCreate();
+    dGeomTriMeshDataBuildSingle(trimesh->id, trimesh->vertices, 3 * sizeof(float), trimesh->vertexCount,
+                                trimesh->indices, trimesh->indexCount, 3 * sizeof(dTriIndex));
+    if (trimesh->flags) {
+      dGeomTriMeshDataSet(trimesh->id, dTRIMESHDATA_USE_FLAGS, (void*) trimesh->flags);
+    } else {
+      dGeomTriMeshDataPreprocess2(trimesh->id, (1U << dTRIDATAPREPROCESS_BUILD_FACE_ANGLES), NULL);
+    }
+  }
+
+  return trimesh->id;
+}
+
+// Takes ownership of the vertices and indices
+TriMesh* lovrTriMeshInit(TriMesh* trimesh, float* vertices, uint32_t vertexCount, dTriIndex* indices, uint32_t indexCount) {
+  trimesh->vertices = vertices;
+  trimesh->indices = indices;
+  trimesh->vertexCount = vertexCount;
+  trimesh->indexCount = indexCount;
+  return trimesh;
+}
+
+TriMesh* lovrTriMeshCreateFromBlob(Blob* blob) {
+  uint64_t key = hash64(&blob, sizeof(blob));
+  if (cookedMeshes.hashes) {
+    uint64_t value = map_get(&cookedMeshes, key);
+    if (value != MAP_NIL) {
+      TriMesh* trimesh = (TriMesh*) (uintptr_t) value;
+      lovrRetain(trimesh);
+      return trimesh;
+    }
+  }
+
+  TriMeshHeader header;
+  lovrAssert(blob->size >= sizeof(header), "Invalid cooked TriMesh data");
+  memcpy(&header, blob->data, sizeof(header));
+  lovrAssert(!memcmp(header.magic, "LTRI", 4), "Invalid cooked TriMesh data");
+  lovrAssert(header.version == TRIMESH_VERSION, "Unsupported cooked TriMesh version %d", header.version);
+  lovrAssert(header.indexSize == sizeof(dTriIndex), "Cooked TriMesh uses %d byte indices, but ODE uses %d byte indices", header.indexSize, (int) sizeof(dTriIndex));
+  lovrAssert(header.indexCount % 3 == 0, "Invalid cooked TriMesh data");
+  size_t vertexSize = (size_t) header.vertexCount * 3 * sizeof(float);
+  size_t indexSize = (size_t) header.indexCount * sizeof(dTriIndex);
+  size_t flagSize = header.indexCount / 3;
+  lovrAssert(blob->size >= sizeof(header) + vertexSize + indexSize + flagSize, "Cooked TriMesh data is truncated");
+  lovrAssert((uintptr_t) blob->data % sizeof(float) == 0, "Cooked TriMesh data must be aligned to 4 bytes");
+
+  float* vertices = (float*) ((char*) blob->data + sizeof(header));
+  dTriIndex* indices = (dTriIndex*) ((char*) vertices + vertexSize);
+  for (uint32_t i = 0; i < header.indexCount; i++) {
+    lovrAssert(indices[i] < header.vertexCount, "Cooked TriMesh data has an invalid vertex index");
+  }
+
+  TriMesh* trimesh = lovrAlloc(TriMesh);
+  trimesh->blob = blob;
+  trimesh->vertices = vertices;
+  trimesh->indices = indices;
+  trimesh->flags = (uint8_t*) indices + indexSize;
+  trimesh->vertexCount = header.vertexCount;
+  trimesh->indexCount = header.indexCount;
+  lovrRetain(blob);
+
+  if (!cookedMeshes.hashes) {
+    map_init(&cookedMeshes, 8);
+  }
+  map_set(&cookedMeshes, key, (uintptr_t) trimesh);
+  return trimesh;
+}
+
+void lovrTriMeshDestroy(void* ref) {
+  TriMesh* trimesh = ref;
+  if (trimesh->id) {
+    dGeomTriMeshDataDestroy(trimesh->id);
+  }
+
+  if (trimesh->blob) {
+    map_remove(&cookedMeshes, hash64(&trimesh->blob, sizeof(trimesh->blob)));
+    if (cookedMeshes.used == 0) {
+      map_free(&cookedMeshes);
+      memset(&cookedMeshes, 0, sizeof(cookedMeshes));
+    }
+    lovrRelease(Blob, trimesh->blob);
+  } else {
+    free(trimesh->vertices);
+    free(trimesh->indices);
+  }
+}
+
+// Cooking welds vertices with the same position and drops degenerate triangles, so the collision
+// tree built from the cooked data is as small as it can be.  ODE can't save the tree itself, but
+// the use flags are worked out here: each edge and vertex shared by several triangles is only used
+// for contacts by the first of them, which keeps ODE from reporting the same contact many times.
+Blob* lovrTriMeshCook(const float* vertices, uint32_t vertexCount, const dTriIndex* indices, uint32_t indexCount) {
+  lovrAssert(vertexCount > 0 && indexCount > 0, "TriMesh needs at least one triangle");
+  lovrAssert(indexCount % 3 == 0, "TriMesh index count must be a multiple of 3");
+  for (uint32_t i = 0; i < indexCount; i++) {
+    lovrAssert(indices[i] < vertexCount, "Invalid TriMesh vertex index");
+  }
+
+  size_t maxSize = sizeof(TriMeshHeader) + vertexCount * 3 * sizeof(float) + indexCount * sizeof(dTriIndex) + indexCount / 3;
+  char* data = malloc(maxSize);
+  uint32_t* remap = malloc(vertexCount * sizeof(uint32_t));
+  uint8_t* vertexUsed = calloc(vertexCount, sizeof(uint8_t));
+  lovrAssert(data && remap && vertexUsed, "Out of memory");
+
+  float* welded = (float*) (data + sizeof(TriMeshHeader));
+  uint32_t weldedCount = 0;
+
+  map_t map;
+  map_init(&map, vertexCount);
+  for (uint32_t i = 0; i < vertexCount; i++) {
+    const float* vertex = vertices + 3 * i;
+    uint64_t hash = hash64(vertex, 3 * sizeof(float));
+    uint64_t index = map_get(&map, hash);
+    if (index != MAP_NIL && !memcmp(welded + 3 * index, vertex, 3 * sizeof(float))) {
+      remap[i] = index;
+    } else {
+      if (index == MAP_NIL) {
+        map_set(&map, hash, weldedCount);
+      }
+      memcpy(welded + 3 * weldedCount, vertex, 3 * sizeof(float));
+      remap[i] = weldedCount++;
+    }
+  }
+  map_free(&map);
+
+  dTriIndex* cooked = (dTriIndex*) (welded + 3 * weldedCount);
+  uint32_t cookedCount = 0;
+  for (uint32_t i = 0; i < indexCount; i += 3) {
+    dTriIndex a = remap[indices[i + 0]];
+    dTriIndex b = remap[indices[i + 1]];
+    dTriIndex c = remap[indices[i + 2]];
+    if (a != b && b != c && a != c) {
+      cooked[cookedCount++] = a;
+      cooked[cookedCount++] = b;
+      cooked[cookedCount++] = c;
+    }
+  }
+  free(remap);
+
+  // Edges are keyed by their sorted vertex pair, which is also stored to catch hash collisions
+  static const uint8_t edgeFlags[] = { dMESHDATAUSE_EDGE1, dMESHDATAUSE_EDGE2, dMESHDATAUSE_EDGE3 };
+  static const uint8_t vertexFlags[] = { dMESHDATAUSE_VERTEX1, dMESHDATAUSE_VERTEX2, dMESHDATAUSE_VERTEX3 };
+  uint8_t* flags = (uint8_t*) (cooked + cookedCount);
+  map_init(&map, cookedCount);
+  for (uint32_t t = 0; t < cookedCount / 3; t++) {
+    dTriIndex* triangle = cooked + 3 * t;
+    flags[t] = 0;
+    for (uint32_t e = 0; e < 3; e++) {
+      uint32_t v1 = MIN(triangle[e], triangle[(e + 1) % 3]);
+      uint32_t v2 = MAX(triangle[e], triangle[(e + 1) % 3]);
+      uint64_t pair = ((uint64_t) v1 << 32) | v2;
+      uint64_t hash = hash64(&pair, sizeof(pair));
+      uint64_t other = map_get(&map, hash);
+      if (other != pair) {
+        flags[t] |= edgeFlags[e];
+        if (other == MAP_NIL) {
+          map_set(&map, hash, pair);
+        }
+      }
+
+      if (!vertexUsed[triangle[e]]) {
+        vertexUsed[triangle[e]] = 1;
+        flags[t] |= vertexFlags[e];
+      }
+    }
+  }
+  map_free(&map);
+  free(vertexUsed);
+
+  TriMeshHeader header = {
+    .magic = { 'L', 'T', 'R', 'I' },
+    .version = TRIMESH_VERSION,
+    .indexSize = sizeof(dTriIndex),
+    .vertexCount = weldedCount,
+    .indexCount = cookedCount
+  };
+  memcpy(data, &header, sizeof(header));
+
+  size_t size = (char*) (flags + cookedCount / 3) - data;
+  return lovrBlobCreate(data, size, "Cooked TriMesh");
+}
+
+MeshShape* lovrMeshShapeInit(MeshShape* mesh, TriMesh* trimesh) {
+  mesh->id = dCreateTriMesh(0, getTriMeshData(trimesh), 0, 0, 0);
   mesh->type = SHAPE_MESH;
+  mesh->trimesh = trimesh;
+  lovrRetain(trimesh);
   dGeomSetData(mesh->id, mesh);
   return mesh;
 }
 
+TriMesh* lovrMeshShapeGetTriMesh(MeshShape* mesh) {
+  return mesh->trimesh;
+}
+
 void lovrJointDestroy(void* ref) {
   Joint* joint = ref;
   lovrJointDestroyData(joint);
@@ -8,6 +8,7 @@
 
 #define MAX_CONTACTS 10
 #define MAX_TAGS 16
+#define MAX_QUADTREE_DEPTH 8
 #define NO_TAG ~0u
 
 typedef enum {
@@ -28,33 +29,118 @@ typedef enum {
 typedef struct Collider Collider;
 typedef struct Shape Shape;
 typedef struct Joint Joint;
+struct Blob;
+
+// Triangles for MeshShapes.  The collision data is built when the first MeshShape uses it, and
+// every MeshShape made from the same TriMesh shares it.  A TriMesh loaded from cooked data points
+// straight into the Blob, and there's only one of them for each Blob.
+typedef struct TriMesh {
+  dTriMeshDataID id;
+  float* vertices;
+  dTriIndex* indices;
+  const uint8_t* flags;
+  uint32_t vertexCount;
+  uint32_t indexCount;
+  struct Blob* blob;
+} TriMesh;
+
+typedef enum {
+  QUERY_RAY,
+  QUERY_SPHERE,
+  QUERY_BOX
+} QueryType;
+
+// Geoms used by batched queries are created once and reused, one set per job worker
+typedef struct {
+  dGeomID ray;
+  dGeomID sphere;
+  dGeomID box;
+} QueryGeoms;
+
+typedef struct {
+  Shape* shape;
+  dReal aabb[6];
+} QueryShape;
+
+typedef enum {
+  BROADPHASE_HASH,
+  BROADPHASE_SAP,
+  BROADPHASE_QUADTREE,
+  BROADPHASE_SIMPLE
+} BroadphaseType;
+
+// The center and size are hints for how big the world is.  The hash space uses the size and the
+// cell size for its levels, the quadtree uses the bounds and the depth.
+typedef struct {
+  BroadphaseType broadphase;
+  bool tagSpaces;
+  bool staticSpace;
+  float center[3];
+  float size[3];
+  float cellSize;
+  uint32_t depth;
+  uint32_t workers;
+} WorldFlags;
+
+typedef enum {
+  POSE_COMPACT,
+  POSE_MATRIX
+} PoseFormat;
+
+typedef struct {
+  Shape* a;
+  Shape* b;
+  float position[3];
+  float normal[3];
+  float depth;
+} Contact;
 
 typedef struct {
   dWorldID id;
   dSpaceID space;
+  dSpaceID staticSpace;
+  dSpaceID tagSpaces[MAX_TAGS + 1];
+  WorldFlags flags;
   dJointGroupID contactGroup;
   arr_t(Shape*) overlaps;
   char* tags[MAX_TAGS];
   uint16_t masks[MAX_TAGS];
-  Collider* head;
+  float friction[MAX_TAGS][MAX_TAGS];
+  float restitution[MAX_TAGS][MAX_TAGS];
+  arr_t(Contact) contacts;
+  arr_t(Collider*) colliders;
+  uint32_t pairsTested;
+  uint32_t pairsAccepted;
+  double collisionTime;
+  float timestep;
+  float accumulator;
+  uint32_t maxSteps;
+  dThreadingImplementationID threading;
+  dThreadingThreadPoolID threadPool;
+  uint32_t workerCount;
+  QueryGeoms* queryGeoms;
+  uint32_t queryGeomCount;
+  arr_t(QueryShape) queryShapes;
 } World;
 
 struct Collider {
   dBodyID body;
   World* world;
-  Collider* prev;
-  Collider* next;
+  uint32_t index;
   void* userdata;
   uint32_t tag;
   arr_t(Shape*) shapes;
   arr_t(Joint*) joints;
   float friction;
   float restitution;
+  float lastPosition[4];
+  float lastOrientation[4];
 };
 
 struct Shape {
   ShapeType type;
   dGeomID id;
+  TriMesh* trimesh;
   Collider* collider;
   void* userdata;
   bool sensor;
@@ -85,10 +171,17 @@ typedef struct {
   void* userdata;
 } RaycastData;
 
+typedef struct {
+  Shape* shape;
+  float position[3];
+  float normal[3];
+  float distance;
+} RaycastHit;
+
 bool lovrPhysicsInit(void);
 void lovrPhysicsDestroy(void);
 
-World* lovrWorldInit(World* world, float xg, float yg, float zg, bool allowSleep, const char** tags, uint32_t tagCount);
+World* lovrWorldInit(World* world, float xg, float yg, float zg, bool allowSleep, const char** tags, uint32_t tagCount, WorldFlags flags);
 #define lovrWorldCreate(...) lovrWorldInit(lovrAlloc(World), __VA_ARGS__)
 void lovrWorldDestroy(void* ref);
 void lovrWorldDestroyData(World* world);
@@ -96,7 +189,13 @@ void lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* u
 void lovrWorldComputeOverlaps(World* world);
 int lovrWorldGetNextOverlap(World* world, Shape** a, Shape** b);
 int lovrWorldCollide(World* world, Shape* a, Shape* b, float friction, float restitution);
-Collider* lovrWorldGetFirstCollider(World* world);
+uint32_t lovrWorldComputeContacts(World* world);
+Contact* lovrWorldGetContacts(World* world, uint32_t* count);
+void lovrWorldResolveContacts(World* world);
+Collider** lovrWorldGetColliders(World* world, size_t* count);
+uint32_t lovrWorldGetPoses(World* world, float* data, PoseFormat format, bool awakeOnly);
+size_t lovrWorldSnapshot(World* world, void* data, size_t size);
+void lovrWorldRestore(World* world, const void* data, size_t size);
 void lovrWorldGetGravity(World* world, float* x, float* y, float* z);
 void lovrWorldSetGravity(World* world, float x, float y, float z);
 float lovrWorldGetResponseTime(World* world);
@@ -110,10 +209,24 @@ void lovrWorldSetAngularDamping(World* world, float damping, float threshold);
 bool lovrWorldIsSleepingAllowed(World* world);
 void lovrWorldSetSleepingAllowed(World* world, bool allowed);
 void lovrWorldRaycast(World* world, float x1, float y1, float z1, float x2, float y2, float z2, RaycastCallback callback, void* userdata);
+// Rays are 6 floats (start and end), sphere sweeps add a radius, box sweeps add a width, height, and
+// depth (boxes are axis aligned).  Each query has maxHits hits, sorted from nearest to farthest.
+uint32_t lovrWorldQueryMany(World* world, QueryType type, const float* queries, uint32_t count, RaycastHit* hits, uint32_t* hitCounts, uint32_t maxHits);
 const char* lovrWorldGetTagName(World* world, uint32_t tag);
 int lovrWorldDisableCollisionBetween(World* world, const char* tag1, const char* tag2);
 int lovrWorldEnableCollisionBetween(World* world, const char* tag1, const char* tag2);
 int lovrWorldIsCollisionEnabledBetween(World* world, const char* tag1, const char* tag);
+bool lovrWorldGetMaterial(World* world, const char* tag1, const char* tag2, float* friction, float* restitution);
+bool lovrWorldSetMaterial(World* world, const char* tag1, const char* tag2, float friction, float restitution);
+void lovrWorldGetPairCounts(World* world, uint32_t* tested, uint32_t* accepted);
+double lovrWorldGetCollisionTime(World* world);
+void lovrWorldGetTimestep(World* world, float* timestep, uint32_t* maxSteps);
+void lovrWorldSetTimestep(World* world, float timestep, uint32_t maxSteps);
+uint32_t lovrWorldGetIterations(World* world);
+void lovrWorldSetIterations(World* world, uint32_t iterations);
+float lovrWorldGetInterpolation(World* world);
+uint32_t lovrWorldGetWorkerCount(World* world);
+void lovrWorldSetWorkerCount(World* world, uint32_t workers);
 
 Collider* lovrColliderInit(Collider* collider, World* world, float x, float y, float z);
 #define lovrColliderCreate(...) lovrColliderInit(lovrAlloc(Collider), __VA_ARGS__)
@@ -149,6 +262,7 @@ void lovrColliderGetPosition(Collider* collider, float* x, float* y, float* z);
 void lovrColliderSetPosition(Collider* collider, float x, float y, float z);
 void lovrColliderGetOrientation(Collider* collider, quat orientation);
 void lovrColliderSetOrientation(Collider* collider, quat orientation);
+void lovrColliderGetInterpolatedPose(Collider* collider, vec3 position, quat orientation);
 void lovrColliderGetLinearVelocity(Collider* collider, float* x, float* y, float* z);
 void lovrColliderSetLinearVelocity(Collider* collider, float x, float y, float z);
 void lovrColliderGetAngularVelocity(Collider* collider, float* x, float* y, float* z);
@@ -214,9 +328,16 @@ void lovrCylinderShapeSetRadius(CylinderShape* cylinder, float radius);
 float lovrCylinderShapeGetLength(CylinderShape* cylinder);
 void lovrCylinderShapeSetLength(CylinderShape* cylinder, float length);
 
-MeshShape* lovrMeshShapeInit(MeshShape* mesh, int vertexCount, float vertices[], int indexCount, dTriIndex indices[]);
+TriMesh* lovrTriMeshInit(TriMesh* trimesh, float* vertices, uint32_t vertexCount, dTriIndex* indices, uint32_t indexCount);
+#define lovrTriMeshCreate(...) lovrTriMeshInit(lovrAlloc(TriMesh), __VA_ARGS__)
+TriMesh* lovrTriMeshCreateFromBlob(struct Blob* blob);
+void lovrTriMeshDestroy(void* ref);
+struct Blob* lovrTriMeshCook(const float* vertices, uint32_t vertexCount, const dTriIndex* indices, uint32_t indexCount);
+
+MeshShape* lovrMeshShapeInit(MeshShape* mesh, TriMesh* trimesh);
 #define lovrMeshShapeCreate(...) lovrMeshShapeInit(lovrAlloc(MeshShape), __VA_ARGS__)
 #define lovrMeshShapeDestroy lovrShapeDestroy
+TriMesh* lovrMeshShapeGetTriMesh(MeshShape* mesh);
 
 void lovrJointDestroy(void* ref);
 void lovrJointDestroyData(Joint* joint);
@@ -6,8 +6,18 @@
 #include "lib/tinycthread/tinycthread.h"
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #include <math.h>
 
+typedef struct {
+  Ref sequence;
+  Variant variant;
+} Slot;
+
+// Channels with a capacity use a bounded ring of slots instead of the locked array.  Each slot has
+// a sequence number that says whether it's ready to be written or read for a given position, so
+// any number of threads can push and pop by claiming positions with a compare and swap.  The lock
+// and condition variable are only used to sleep when the ring is empty or full.
 struct Channel {
   mtx_t lock;
   cnd_t cond;
@@ -16,14 +26,34 @@ struct Channel {
   uint64_t sent;
   uint64_t received;
   uint64_t hash;
+  Slot* ring;
+  uint32_t capacity;
+  Ref pushPosition;
+  Ref popPosition;
+  Ref sleepers;
 };
 
-Channel* lovrChannelCreate(uint64_t hash) {
+Channel* lovrChannelCreate(uint64_t hash, uint32_t capacity) {
   Channel* channel = lovrAlloc(Channel);
   arr_init(&channel->messages);
   mtx_init(&channel->lock, mtx_plain | mtx_timed);
   cnd_init(&channel->cond);
   channel->hash = hash;
+
+  if (capacity > 0) {
+    lovrAssert(capacity <= (1u << 30), "Channel capacity is too big (max is %d)", 1 << 30);
+    channel->capacity = 1;
+    while (channel->capacity < capacity) {
+      channel->capacity <<= 1;
+    }
+
+    channel->ring = calloc(channel->capacity, sizeof(Slot));
+    lovrAssert(channel->ring, "Out of memory");
+    for (uint32_t i = 0; i < channel->capacity; i++) {
+      ref_set(&channel->ring[i].sequence, i);
+    }
+  }
+
   return channel;
 }
 
@@ -31,11 +61,111 @@ void lovrChannelDestroy(void* ref) {
   Channel* channel = ref;
   lovrChannelClear(channel);
   arr_free(&channel->messages);
+  free(channel->ring);
   mtx_destroy(&channel->lock);
   cnd_destroy(&channel->cond);
 }
 
+static bool ringPush(Channel* channel, Variant* variant, uint32_t* position) {
+  uint32_t mask = channel->capacity - 1;
+  uint32_t p = ref_get(&channel->pushPosition);
+
+  for (;;) {
+    Slot* slot = &channel->ring[p & mask];
+    int32_t difference = (int32_t) (ref_get(&slot->sequence) - p);
+
+    if (difference == 0) {
+      if (ref_cas(&channel->pushPosition, p, p + 1)) {
+        slot->variant = *variant;
+        ref_set(&slot->sequence, p + 1);
+        *position = p;
+        return true;
+      }
+    } else if (difference < 0) {
+      return false;
+    }
+
+    p = ref_get(&channel->pushPosition);
+  }
+}
+
+static bool ringPop(Channel* channel, Variant* variant) {
+  uint32_t mask = channel->capacity - 1;
+  uint32_t p = ref_get(&channel->popPosition);
+
+  for (;;) {
+    Slot* slot = &channel->ring[p & mask];
+    int32_t difference = (int32_t) (ref_get(&slot->sequence) - (p + 1));
+
+    if (difference == 0) {
+      if (ref_cas(&channel->popPosition, p, p + 1)) {
+        *variant = slot->variant;
+        ref_set(&slot->sequence, p + mask + 1);
+        return true;
+      }
+    } else if (difference < 0) {
+      return false;
+    }
+
+    p = ref_get(&channel->popPosition);
+  }
+}
+
+// Sleeping threads are woken up by the other side, but only if someone is actually sleeping
+static void ringWake(Channel* channel) {
+  if (ref_get(&channel->sleepers) > 0) {
+    mtx_lock(&channel->lock);
+    cnd_broadcast(&channel->cond);
+    mtx_unlock(&channel->lock);
+  }
+}
+
+// Waits on the condition variable and subtracts the time spent from the timeout, the lock must be held
+static void waitTimeout(Channel* channel, double* timeout) {
+  if (isinf(*timeout)) {
+    cnd_wait(&channel->cond, &channel->lock);
+  } else {
+    struct timespec start;
+    struct timespec until;
+    struct timespec stop;
+    timespec_get(&start, TIME_UTC);
+    double whole, fraction;
+    fraction = modf(*timeout, &whole);
+    until.tv_sec = start.tv_sec + whole;
+    until.tv_nsec = start.tv_nsec + fraction * 1e9;
+    if (until.tv_nsec >= 1000000000) {
+      until.tv_sec++;
+      until.tv_nsec -= 1000000000;
+    }
+    cnd_timedwait(&channel->cond, &channel->lock, &until);
+    timespec_get(&stop, TIME_UTC);
+    *timeout -= (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+  }
+}
+
 bool lovrChannelPush(Channel* channel, Variant* variant, double timeout, uint64_t* id) {
+  if (channel->ring) {
+    uint32_t position;
+    bool pushed = ringPush(channel, variant, &position);
+
+    if (!pushed && !isnan(timeout) && timeout >= 0) {
+      ref_inc(&channel->sleepers);
+      mtx_lock(&channel->lock);
+      while (!(pushed = ringPush(channel, variant, &position)) && timeout >= 0) {
+        waitTimeout(channel, &timeout);
+      }
+      mtx_unlock(&channel->lock);
+      ref_dec(&channel->sleepers);
+    }
+
+    if (pushed) {
+      ringWake(channel);
+    }
+
+    *id = pushed ? (uint64_t) position + 1 : 0;
+    return pushed && lovrChannelHasRead(channel, *id);
+  }
+
   mtx_lock(&channel->lock);
   if (channel->messages.length == 0) {
     lovrRetain(channel);
@@ -73,6 +203,26 @@ bool lovrChannelPush(Channel* channel, Variant* variant, double timeout, uint64_
 }
 
 bool lovrChannelPop(Channel* channel, Variant* variant, double timeout) {
+  if (channel->ring) {
+    bool popped = ringPop(channel, variant);
+
+    if (!popped && !isnan(timeout) && timeout >= 0) {
+      ref_inc(&channel->sleepers);
+      mtx_lock(&channel->lock);
+      while (!(popped = ringPop(channel, variant)) && timeout >= 0) {
+        waitTimeout(channel, &timeout);
+      }
+      mtx_unlock(&channel->lock);
+      ref_dec(&channel->sleepers);
+    }
+
+    if (popped) {
+      ringWake(channel);
+    }
+
+    return popped;
+  }
+
   mtx_lock(&channel->lock);
 
   do {
@@ -109,7 +259,39 @@ bool lovrChannelPop(Channel* channel, Variant* variant, double timeout) {
   } while (1);
 }
 
+size_t lovrChannelPopMany(Channel* channel, Variant* variants, size_t count) {
+  size_t popped = 0;
+
+  if (channel->ring) {
+    while (popped < count && ringPop(channel, &variants[popped])) {
+      popped++;
+    }
+
+    if (popped > 0) {
+      ringWake(channel);
+    }
+
+    return popped;
+  }
+
+  mtx_lock(&channel->lock);
+  popped = MIN(count, channel->messages.length - channel->head);
+  if (popped > 0) {
+    memcpy(variants, channel->messages.data + channel->head, popped * sizeof(Variant));
+    channel->head += popped;
+    channel->received += popped;
+    if (channel->head == channel->messages.length) {
+      channel->head = channel->messages.length = 0;
+      lovrRelease(Channel, channel);
+    }
+    cnd_broadcast(&channel->cond);
+  }
+  mtx_unlock(&channel->lock);
+  return popped;
+}
+
 bool lovrChannelPeek(Channel* channel, Variant* variant) {
+  lovrAssert(!channel->ring, "Channels with a capacity can not be peeked");
   mtx_lock(&channel->lock);
 
   if (channel->head < channel->messages.length) {
@@ -123,6 +305,15 @@ bool lovrChannelPeek(Channel* channel, Variant* variant) {
 }
 
 void lovrChannelClear(Channel* channel) {
+  if (channel->ring) {
+    Variant variant;
+    while (ringPop(channel, &variant)) {
+      lovrVariantDestroy(&variant);
+    }
+    ringWake(channel);
+    return;
+  }
+
   mtx_lock(&channel->lock);
   for (size_t i = channel->head; i < channel->messages.length; i++) {
     lovrVariantDestroy(&channel->messages.data[i]);
@@ -135,13 +326,28 @@ void lovrChannelClear(Channel* channel) {
 }
 
 uint64_t lovrChannelGetCount(Channel* channel) {
+  if (channel->ring) {
+    uint32_t pushed = ref_get(&channel->pushPosition);
+    uint32_t popped = ref_get(&channel->popPosition);
+    return (int32_t) (pushed - popped) > 0 ? pushed - popped : 0;
+  }
+
   mtx_lock(&channel->lock);
   uint64_t length = channel->messages.length - channel->head;
   mtx_unlock(&channel->lock);
   return length;
 }
 
+uint32_t lovrChannelGetCapacity(Channel* channel) {
+  return channel->capacity;
+}
+
+// Ring positions are 32 bits and wrap around, so ids are compared relative to the read position
 bool lovrChannelHasRead(Channel* channel, uint64_t id) {
+  if (channel->ring) {
+    return (int32_t) (ref_get(&channel->popPosition) - (uint32_t) id) >= 0;
+  }
+
   mtx_lock(&channel->lock);
   bool received = channel->received >= id;
   mtx_unlock(&channel->lock);
@@ -1,4 +1,5 @@
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #pragma once
@@ -6,11 +7,13 @@
 struct Variant;
 
 typedef struct Channel Channel;
-Channel* lovrChannelCreate(uint64_t hash);
+Channel* lovrChannelCreate(uint64_t hash, uint32_t capacity);
 void lovrChannelDestroy(void* ref);
 bool lovrChannelPush(Channel* channel, struct Variant* variant, double timeout, uint64_t* id);
 bool lovrChannelPop(Channel* channel, struct Variant* variant, double timeout);
+size_t lovrChannelPopMany(Channel* channel, struct Variant* variants, size_t count);
 bool lovrChannelPeek(Channel* channel, struct Variant* variant);
 void lovrChannelClear(Channel* channel);
 uint64_t lovrChannelGetCount(Channel* channel);
+uint32_t lovrChannelGetCapacity(Channel* channel);
 bool lovrChannelHasRead(Channel* channel, uint64_t id);
@@ -12,21 +12,29 @@ typedef union {
   Channel* channel;
 } ChannelEntry;
 
+struct Job {
+  JobCounter counter;
+  void (*cleanup)(void* context);
+  void* context;
+};
+
 static struct {
   bool initialized;
   mtx_t channelLock;
   map_t channels;
 } state;
 
-bool lovrThreadModuleInit() {
+bool lovrThreadModuleInit(uint32_t workerCount) {
   if (state.initialized) return false;
   mtx_init(&state.channelLock, mtx_plain);
   map_init(&state.channels, 0);
+  job_init(workerCount);
   return state.initialized = true;
 }
 
 void lovrThreadModuleDestroy() {
   if (!state.initialized) return;
+  job_destroy();
   for (size_t i = 0; i < state.channels.size; i++) {
     if (state.channels.values[i] != MAP_NIL) {
       ChannelEntry entry = { state.channels.values[i] };
@@ -38,18 +46,22 @@ void lovrThreadModuleDestroy() {
   state.initialized = false;
 }
 
-Channel* lovrThreadGetChannel(const char* name) {
+// The capacity only matters for the first call that creates the Channel, a capacity of zero means
+// the Channel is unbounded (and locked).  Later calls can leave it out.
+Channel* lovrThreadGetChannel(const char* name, uint32_t capacity) {
   uint64_t hash = hash64(name, strlen(name));
 
   mtx_lock(&state.channelLock);
   ChannelEntry entry = { map_get(&state.channels, hash) };
 
   if (entry.u64 == MAP_NIL) {
-    entry.channel = lovrChannelCreate(hash);
+    entry.channel = lovrChannelCreate(hash, capacity);
     map_set(&state.channels, hash, entry.u64);
   }
 
   mtx_unlock(&state.channelLock);
+  uint32_t actual = lovrChannelGetCapacity(entry.channel);
+  lovrAssert(capacity == 0 || capacity <= actual, "Channel '%s' already exists with a capacity of %d", name, actual);
   return entry.channel;
 }
 
@@ -100,3 +112,34 @@ bool lovrThreadIsRunning(Thread* thread) {
 const char* lovrThreadGetError(Thread* thread) {
   return thread->error;
 }
+
+Job* lovrJobCreate() {
+  return lovrAlloc(Job);
+}
+
+void lovrJobDestroy(void* ref) {
+  Job* job = ref;
+  lovrJobWait(job);
+}
+
+// A Job only tracks one batch of work at a time, so the previous one is finished first.  The
+// cleanup callback runs on the thread that waits, which makes it safe to release objects there.
+void lovrJobRun(Job* job, jobFn* fn, void* context, uint32_t count, void (*cleanup)(void* context)) {
+  lovrJobWait(job);
+  job->cleanup = cleanup;
+  job->context = context;
+  job_run(fn, context, count, &job->counter, NULL);
+}
+
+void lovrJobWait(Job* job) {
+  job_wait(&job->counter);
+  if (job->cleanup) {
+    job->cleanup(job->context);
+    job->cleanup = NULL;
+    job->context = NULL;
+  }
+}
+
+bool lovrJobIsComplete(Job* job) {
+  return job_done(&job->counter);
+}
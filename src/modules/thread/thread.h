@@ -1,5 +1,6 @@
 #include "data/blob.h"
 #include "event/event.h"
+#include "core/job.h"
 #include "lib/tinycthread/tinycthread.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -24,9 +25,9 @@ typedef struct Thread {
   bool running;
 } Thread;
 
-bool lovrThreadModuleInit(void);
+bool lovrThreadModuleInit(uint32_t workerCount);
 void lovrThreadModuleDestroy(void);
-struct Channel* lovrThreadGetChannel(const char* name);
+struct Channel* lovrThreadGetChannel(const char* name, uint32_t capacity);
 void lovrThreadRemoveChannel(uint64_t hash);
 
 Thread* lovrThreadInit(Thread* thread, int (*runner)(void*), Blob* body);
@@ -36,3 +37,10 @@ void lovrThreadStart(Thread* thread, Variant* arguments, size_t argumentCount);
 void lovrThreadWait(Thread* thread);
 const char* lovrThreadGetError(Thread* thread);
 bool lovrThreadIsRunning(Thread* thread);
+
+typedef struct Job Job;
+Job* lovrJobCreate(void);
+void lovrJobDestroy(void* ref);
+void lovrJobRun(Job* job, jobFn* fn, void* context, uint32_t count, void (*cleanup)(void* context));
+void lovrJobWait(Job* job);
+bool lovrJobIsComplete(Job* job);
@@ -122,7 +122,11 @@ function lovr.boot()
       msaa = 4
     },
     math = {
-      globals = true
+      globals = true,
+      poolsize = 2 ^ 20
+    },
+    thread = {
+      workers = -1
     },
     window = {
       width = 1080,